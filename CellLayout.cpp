@@ -0,0 +1,27 @@
+#include "CellLayout.h"
+
+CellLayout::CellLayout() : order(CellOrder::RowMajor), rows(0), cols(0), tilesAcross(0), tileCount(0), slots(0) {}
+
+void CellLayout::reset(int gridRows, int gridCols, CellOrder cellOrder) {
+    order = cellOrder;
+    rows = gridRows;
+    cols = gridCols;
+    tilesAcross = (cols + TILE_SIZE - 1) >> TILE_SHIFT;
+    tileCount = tilesAcross * ((rows + TILE_SIZE - 1) >> TILE_SHIFT);
+    if (order == CellOrder::RowMajor) {
+        slots = static_cast<size_t>(rows) * cols;
+    } else {
+        slots = static_cast<size_t>(tileCount) * TILE_SLOTS;
+    }
+}
+
+// Cell stored in `slot`; may lie past the last row or column for padding
+std::pair<int, int> CellLayout::cellOf(int slot) const {
+    if (order == CellOrder::RowMajor) {
+        return {slot / cols, slot % cols};
+    }
+    int tile = slot >> (2 * TILE_SHIFT);
+    int code = slot & (TILE_SLOTS - 1);
+    return {(tile / tilesAcross) * TILE_SIZE + compactBits(code >> 1),
+            (tile % tilesAcross) * TILE_SIZE + compactBits(code)};
+}
@@ -0,0 +1,99 @@
+#ifndef CELL_LAYOUT_H
+#define CELL_LAYOUT_H
+
+#include <utility>
+#include <cstddef>
+
+// Order in which per-cell data of a grid is stored
+enum class CellOrder {
+    RowMajor, // Slot = row * cols + col, like CityGrid's own indices
+    ZOrder    // 32x32 tiles in row-major order, Morton (Z) order inside a tile
+};
+
+// Maps grid cells to storage slots for per-cell arrays.
+// Under ZOrder a 4x4 block of cells shares one 64-byte line of an int
+// array and a 32x32 tile fills one 4 KB page, so the cells above and below
+// a cell are usually a few slots away instead of a whole row. Searches
+// that only step through neighborsOf() work under either order. Edge tiles
+// are padded to full size, so slotCount() can exceed the cell count;
+// padding slots belong to no cell and must be treated as blocked.
+class CellLayout {
+private:
+    CellOrder order;
+    int rows;
+    int cols;
+    int tilesAcross;
+    int tileCount;
+    size_t slots;
+
+    static const int X_BITS = 0x155; // Column bits of a Morton code
+    static const int Y_BITS = 0x2AA; // Row bits
+
+    static int spreadBits(int value);  // 5 bits to every other bit
+    static int compactBits(int value); // Inverse of spreadBits
+
+public:
+    static const int TILE_SHIFT = 5;
+    static const int TILE_SIZE = 1 << TILE_SHIFT;
+    static const int TILE_SLOTS = TILE_SIZE * TILE_SIZE;
+
+    CellLayout();
+
+    void reset(int gridRows, int gridCols, CellOrder cellOrder);
+    CellOrder getOrder() const { return order; }
+    size_t slotCount() const { return slots; }
+
+    int slotOf(int row, int col) const {
+        if (order == CellOrder::RowMajor) {
+            return row * cols + col;
+        }
+        int tile = (row >> TILE_SHIFT) * tilesAcross + (col >> TILE_SHIFT);
+        return (tile << (2 * TILE_SHIFT)) | spreadBits(col & (TILE_SIZE - 1)) |
+               (spreadBits(row & (TILE_SIZE - 1)) << 1);
+    }
+    std::pair<int, int> cellOf(int slot) const;
+
+    // Slots of the right, left, down and up neighbors, -1 past the edge.
+    // Under ZOrder a neighbor past the last row or column is a padding slot.
+    void neighborsOf(int slot, int out[4]) const {
+        if (order == CellOrder::RowMajor) {
+            int row = slot / cols;
+            int col = slot % cols;
+            out[0] = col + 1 < cols ? slot + 1 : -1;
+            out[1] = col > 0 ? slot - 1 : -1;
+            out[2] = row + 1 < rows ? slot + cols : -1;
+            out[3] = row > 0 ? slot - cols : -1;
+            return;
+        }
+        // Step the column or row bits of the code with the carry (or
+        // borrow) running through the other bits; at a tile edge move to
+        // the next tile and wrap the code to its far side
+        int tile = slot >> (2 * TILE_SHIFT);
+        int code = slot & (TILE_SLOTS - 1);
+        int base = slot - code;
+        int x = code & X_BITS, y = code & Y_BITS;
+        out[0] = x != X_BITS ? base | (((code | Y_BITS) + 1) & X_BITS) | y
+                             : (tile % tilesAcross + 1 < tilesAcross ? base + TILE_SLOTS + y : -1);
+        out[1] = x != 0 ? base | ((x - 1) & X_BITS) | y
+                        : (tile % tilesAcross > 0 ? base - TILE_SLOTS + (X_BITS | y) : -1);
+        out[2] = y != Y_BITS ? base | (((code | X_BITS) + 1) & Y_BITS) | x
+                             : (tile + tilesAcross < tileCount ? base + tilesAcross * TILE_SLOTS + x : -1);
+        out[3] = y != 0 ? base | ((y - 1) & Y_BITS) | x
+                        : (tile >= tilesAcross ? base - tilesAcross * TILE_SLOTS + (Y_BITS | x) : -1);
+    }
+};
+
+inline int CellLayout::spreadBits(int value) {
+    value = (value | (value << 4)) & 0x0F0F;
+    value = (value | (value << 2)) & 0x3333;
+    return (value | (value << 1)) & 0x5555;
+}
+
+inline int CellLayout::compactBits(int value) {
+    value &= 0x5555;
+    value = (value | (value >> 1)) & 0x3333;
+    value = (value | (value >> 2)) & 0x0F0F;
+    return (value | (value >> 4)) & 0x00FF;
+}
+
+#endif // CELL_LAYOUT_H
@@ -0,0 +1,116 @@
+#include "CityGrid.h"
+#include <algorithm> // For fill
+
+CityGrid::CityGrid(int gridRows, int gridCols) : rows(0), cols(0), userCell(-1) {
+    resize(gridRows, gridCols);
+}
+
+// Change the map size, all terrain and entities are dropped
+void CityGrid::resize(int gridRows, int gridCols) {
+    rows = gridRows;
+    cols = gridCols;
+    blockedBits.assign((cellCount() + 63) / 64, 0);
+    slowBits.clear();
+    clearEntities();
+}
+
+void CityGrid::clear() {
+    std::fill(blockedBits.begin(), blockedBits.end(), 0);
+    clearEntities();
+}
+
+void CityGrid::clearEntities() {
+    userCell = -1;
+    driverLayer.clear();
+    signalLayer.clear();
+    stationLayer.clear();
+    zoneLayer.clear();
+    std::fill(slowBits.begin(), slowBits.end(), 0); // Keeps the allocation for the next repopulate
+}
+
+void CityGrid::setBlocked(int row, int col, bool blocked) {
+    int index = indexOf(row, col);
+    if (blocked) {
+        blockedBits[index >> 6] |= uint64_t(1) << (index & 63);
+    } else {
+        blockedBits[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    }
+}
+
+void CityGrid::setUser(std::pair<int, int> pos) {
+    userCell = indexOf(pos.first, pos.second);
+}
+
+// A later driver on the same cell replaces the earlier one, as on the old char grid
+void CityGrid::placeDriver(std::pair<int, int> pos, int driverIndex) {
+    driverLayer[indexOf(pos.first, pos.second)] = driverIndex;
+}
+
+// Cells with a non-road cost are flagged in a bitset, so routing only
+// hashes into the sparse layers for cells that actually hold something
+void CityGrid::markSlow(int index) {
+    if (slowBits.empty()) {
+        slowBits.assign(blockedBits.size(), 0);
+    }
+    slowBits[index >> 6] |= uint64_t(1) << (index & 63);
+}
+
+void CityGrid::addTrafficSignal(std::pair<int, int> pos) {
+    int index = indexOf(pos.first, pos.second);
+    signalLayer.insert(index);
+    markSlow(index);
+}
+
+void CityGrid::addFuelStation(std::pair<int, int> pos) {
+    stationLayer.insert(indexOf(pos.first, pos.second));
+}
+
+void CityGrid::addCongestionZone(std::pair<int, int> pos) {
+    int index = indexOf(pos.first, pos.second);
+    zoneLayer.insert(index);
+    markSlow(index);
+}
+
+int CityGrid::driverAt(std::pair<int, int> pos) const {
+    auto it = driverLayer.find(indexOf(pos.first, pos.second));
+    return it == driverLayer.end() ? -1 : it->second;
+}
+
+bool CityGrid::hasTrafficSignal(std::pair<int, int> pos) const {
+    return signalLayer.count(indexOf(pos.first, pos.second)) > 0;
+}
+
+bool CityGrid::hasFuelStation(std::pair<int, int> pos) const {
+    return stationLayer.count(indexOf(pos.first, pos.second)) > 0;
+}
+
+bool CityGrid::hasCongestionZone(std::pair<int, int> pos) const {
+    return zoneLayer.count(indexOf(pos.first, pos.second)) > 0;
+}
+
+int CityGrid::traversalCost(int index, const TraversalCosts &costs) const {
+    if (slowBits.empty() || !((slowBits[index >> 6] >> (index & 63)) & 1)) return costs.road;
+    if (zoneLayer.count(index)) return costs.congestionZone;
+    if (signalLayer.count(index)) return costs.trafficSignal;
+    return costs.road;
+}
+
+// Layers are drawn in the same precedence updateGrid used to write them:
+// congestion zones, fuel stations, signals, obstacles, drivers, then the user
+char CityGrid::cellAt(int row, int col) const {
+    int index = indexOf(row, col);
+    if (zoneLayer.count(index)) return 'R';
+    if (stationLayer.count(index)) return 'F';
+    if (signalLayer.count(index)) return 'T';
+    if (!isPassable(index)) return '#';
+    auto driver = driverLayer.find(index);
+    if (driver != driverLayer.end()) return static_cast<char>('A' + driver->second);
+    if (index == userCell) return 'U';
+    return '.';
+}
+
+size_t CityGrid::memoryUsage() const {
+    size_t perEntry = sizeof(int) * 2 + sizeof(void *) * 2; // Key, value and bucket overhead
+    return (blockedBits.capacity() + slowBits.capacity()) * sizeof(uint64_t) +
+           (driverLayer.size() + signalLayer.size() + stationLayer.size() + zoneLayer.size()) * perEntry;
+}
@@ -0,0 +1,80 @@
+#ifndef CITY_GRID_H
+#define CITY_GRID_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+
+// Time to drive into a cell, by what occupies it. Costs are small positive
+// integers; a cell holding both a signal and a congestion zone costs as a zone.
+struct TraversalCosts {
+    int road = 1;           // Plain cells, stations, drivers and the user
+    int trafficSignal = 3;  // 'T'
+    int congestionZone = 5; // 'R'
+};
+
+// Runtime-sized city map.
+// Terrain is a bitset with one bit per cell (set = obstacle), in flat
+// row-major order (index = row * cols + col). Searches only read these bits.
+// Entities are kept in separate sparse layers keyed by cell index, so a
+// 16k x 16k map costs 32 MB for terrain plus a few bytes per entity
+// (and another 32 MB bitset once it has signals or congestion zones).
+// Cell indices are ints, so rows * cols must stay below 2^31.
+class CityGrid {
+private:
+    int rows;
+    int cols;
+    std::vector<uint64_t> blockedBits;
+
+    // Sparse entity layers
+    int userCell;                              // -1 when there is no user
+    std::unordered_map<int, int> driverLayer;  // Cell -> driver index
+    std::unordered_set<int> signalLayer;       // Traffic signals
+    std::unordered_set<int> stationLayer;      // Fuel stations
+    std::unordered_set<int> zoneLayer;         // Congestion zones
+    std::vector<uint64_t> slowBits;            // Set where a signal or zone sits, empty until the first one
+
+    void markSlow(int index);
+
+public:
+    CityGrid(int gridRows, int gridCols);
+
+    void resize(int gridRows, int gridCols); // Clears the map
+    void clear();                            // Removes all terrain and entities
+    void clearEntities();
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    size_t cellCount() const { return static_cast<size_t>(rows) * cols; }
+    int indexOf(int row, int col) const { return row * cols + col; }
+    bool inBounds(int row, int col) const { return row >= 0 && row < rows && col >= 0 && col < cols; }
+
+    // Terrain
+    bool isPassable(int index) const { return !((blockedBits[index >> 6] >> (index & 63)) & 1); }
+    bool isPassable(int row, int col) const { return isPassable(indexOf(row, col)); }
+    void setBlocked(int row, int col, bool blocked);
+    const std::vector<uint64_t> &getBlockedBits() const { return blockedBits; }
+
+    // Entities
+    void setUser(std::pair<int, int> pos);
+    void placeDriver(std::pair<int, int> pos, int driverIndex);
+    void addTrafficSignal(std::pair<int, int> pos);
+    void addFuelStation(std::pair<int, int> pos);
+    void addCongestionZone(std::pair<int, int> pos);
+    int driverAt(std::pair<int, int> pos) const; // -1 if no driver
+    bool hasTrafficSignal(std::pair<int, int> pos) const;
+    bool hasFuelStation(std::pair<int, int> pos) const;
+    bool hasCongestionZone(std::pair<int, int> pos) const;
+    // Cost of entering the cell at `index` under `costs`
+    int traversalCost(int index, const TraversalCosts &costs) const;
+
+    // Character shown for a cell when the map is printed
+    char cellAt(int row, int col) const;
+    // Approximate heap memory held by the map in bytes
+    size_t memoryUsage() const;
+};
+
+#endif // CITY_GRID_H
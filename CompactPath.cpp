@@ -0,0 +1,120 @@
+#include "CompactPath.h"
+
+const uint8_t RUN_FLAG = 0x80;
+const int MAX_RUN = 32;
+const int LITERAL_STEPS = 3;
+
+// Row and column change of each direction code
+static const int STEP_ROW[4] = {0, 0, 1, -1};
+static const int STEP_COL[4] = {1, -1, 0, 0};
+
+// Direction code of one step, -1 if the cells are not adjacent
+static int directionOf(std::pair<int, int> from, std::pair<int, int> to) {
+    int dRow = to.first - from.first;
+    int dCol = to.second - from.second;
+    for (int d = 0; d < 4; d++) {
+        if (STEP_ROW[d] == dRow && STEP_COL[d] == dCol) {
+            return d;
+        }
+    }
+    return -1;
+}
+
+CompactPath::CompactPath() : first(-1, -1), last(-1, -1), steps(0) {}
+
+bool CompactPath::assign(const std::vector<std::pair<int, int>> &path) {
+    clear();
+    if (path.empty()) {
+        return true;
+    }
+    for (size_t i = 1; i < path.size(); i++) {
+        if (directionOf(path[i - 1], path[i]) < 0) {
+            return false;
+        }
+    }
+    auto direction = [&path](size_t step) { return directionOf(path[step], path[step + 1]); };
+
+    // Runs of three or more become run codes, anything shorter goes in literals
+    size_t i = 0, count = path.size() - 1;
+    while (i < count) {
+        int current = direction(i);
+        size_t run = 1;
+        while (i + run < count && run < MAX_RUN && direction(i + run) == current) {
+            run++;
+        }
+        if (run >= LITERAL_STEPS || count - i < LITERAL_STEPS) {
+            codes.push_back(static_cast<uint8_t>(RUN_FLAG | (current << 5) | (run - 1)));
+            i += run;
+        } else {
+            codes.push_back(static_cast<uint8_t>((current << 4) | (direction(i + 1) << 2) | direction(i + 2)));
+            i += LITERAL_STEPS;
+        }
+    }
+    first = path.front();
+    last = path.back();
+    steps = count;
+    return true;
+}
+
+void CompactPath::clear() {
+    first = {-1, -1};
+    last = {-1, -1};
+    steps = 0;
+    codes.clear();
+}
+
+void CompactPath::decode(std::vector<std::pair<int, int>> &path) const {
+    path.clear();
+    if (empty()) {
+        return;
+    }
+    path.reserve(steps + 1);
+    PathCursor cursor = begin();
+    path.push_back(cursor.cell);
+    while (!atEnd(cursor)) {
+        advance(cursor);
+        path.push_back(cursor.cell);
+    }
+}
+
+PathCursor CompactPath::begin() const {
+    return PathCursor{0, 0, 0, first};
+}
+
+bool CompactPath::atEnd(const PathCursor &cursor) const {
+    return cursor.index >= steps;
+}
+
+void CompactPath::advance(PathCursor &cursor) const {
+    uint8_t code = codes[cursor.code];
+    int direction, length;
+    if (code & RUN_FLAG) {
+        direction = (code >> 5) & 3;
+        length = (code & 31) + 1;
+    } else {
+        direction = (code >> (4 - 2 * cursor.offset)) & 3;
+        length = LITERAL_STEPS;
+    }
+    cursor.cell.first += STEP_ROW[direction];
+    cursor.cell.second += STEP_COL[direction];
+    cursor.index++;
+    if (++cursor.offset == length) {
+        cursor.code++;
+        cursor.offset = 0;
+    }
+}
+
+bool CompactPath::containsFrom(const PathCursor &cursor, std::pair<int, int> cell) const {
+    PathCursor walker = cursor;
+    while (walker.cell != cell) {
+        if (atEnd(walker)) {
+            return false;
+        }
+        advance(walker);
+    }
+    return true;
+}
+
+size_t CompactPath::memoryUsage() const {
+    return sizeof(CompactPath) + codes.capacity();
+}
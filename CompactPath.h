@@ -0,0 +1,53 @@
+#ifndef COMPACT_PATH_H
+#define COMPACT_PATH_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// Position while walking a CompactPath, advanced by CompactPath::advance()
+struct PathCursor {
+    size_t code;    // Code byte being read
+    int offset;     // Steps already taken from that byte
+    size_t index;   // Cells passed since the first one
+    std::pair<int, int> cell;
+};
+
+// A 4-connected route stored as 2-bit direction codes
+// (0 right, 1 left, 2 down, 3 up) after its first cell, one byte per code:
+//  - 1ddlllll: a run of l + 1 (1 to 32) steps in direction dd;
+//  - 00aabbcc: three single steps aa, bb, cc, for twisting stretches.
+// A step never costs more than a third of a byte, against 8 bytes per cell
+// for a vector of pairs. A cursor walks the route in O(1) per step without
+// decoding it.
+class CompactPath {
+private:
+    std::pair<int, int> first;
+    std::pair<int, int> last;
+    size_t steps;
+    std::vector<uint8_t> codes;
+
+public:
+    CompactPath();
+
+    // Encode a route of adjacent cells; false (and empty) if two are not adjacent
+    bool assign(const std::vector<std::pair<int, int>> &path);
+    void clear();
+    // Every cell, first and last included
+    void decode(std::vector<std::pair<int, int>> &path) const;
+
+    PathCursor begin() const;                    // At the first cell
+    bool atEnd(const PathCursor &cursor) const;  // At the last cell
+    void advance(PathCursor &cursor) const;      // One step, must not be atEnd
+    // Whether `cell` is still ahead of the cursor (its own cell included)
+    bool containsFrom(const PathCursor &cursor, std::pair<int, int> cell) const;
+
+    bool empty() const { return first.first < 0; }
+    size_t size() const { return first.first < 0 ? 0 : steps + 1; } // Cells, like the vector it encodes
+    std::pair<int, int> front() const { return first; }
+    std::pair<int, int> back() const { return last; }
+    size_t memoryUsage() const; // Bytes held, object included
+};
+
+#endif // COMPACT_PATH_H
@@ -0,0 +1,277 @@
+#include "ComponentLabels.h"
+#include <algorithm> // For fill
+
+ComponentLabels::ComponentLabels() : rows(0), cols(0), built(false), markGeneration(0) {}
+
+void ComponentLabels::setBlockedBit(int index, bool blocked) {
+    if (blocked) {
+        blockedBits[index >> 6] |= uint64_t(1) << (index & 63);
+    } else {
+        blockedBits[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    }
+}
+
+// Root label of `l`, halving the path on the way
+int ComponentLabels::findRoot(int l) {
+    while (labelParent[l] != l) {
+        labelParent[l] = labelParent[labelParent[l]];
+        l = labelParent[l];
+    }
+    return l;
+}
+
+// Point every label straight at its root so lookups need no find
+void ComponentLabels::flatten() {
+    for (int l = 0; l < static_cast<int>(labelParent.size()); l++) {
+        labelParent[l] = findRoot(l);
+    }
+}
+
+// A newly opened cell joins (and so merges) the components around it
+void ComponentLabels::openCell(int index) {
+    setBlockedBit(index, false);
+    int row = index / cols;
+    int col = index % cols;
+    int neighbors[4] = {
+        col + 1 < cols ? index + 1 : -1,
+        col > 0 ? index - 1 : -1,
+        row + 1 < rows ? index + cols : -1,
+        row > 0 ? index - cols : -1
+    };
+    int root = -1;
+    for (int next : neighbors) {
+        if (next < 0 || isBlocked(next)) {
+            continue;
+        }
+        int other = findRoot(label[next]);
+        if (root < 0) {
+            root = other;
+        } else if (other != root) {
+            labelParent[other] = root;
+        }
+    }
+    if (root < 0) {
+        root = static_cast<int>(labelParent.size()); // Isolated cell, new component
+        labelParent.push_back(root);
+    }
+    label[index] = root;
+}
+
+// A newly blocked cell may cut its component in pieces; find out with
+// interleaved searches from its open neighbors
+void ComponentLabels::blockCell(int index) {
+    setBlockedBit(index, true);
+    label[index] = -1;
+    int row = index / cols;
+    int col = index % cols;
+    int neighbors[4] = {
+        col + 1 < cols ? index + 1 : -1,
+        col > 0 ? index - 1 : -1,
+        row + 1 < rows ? index + cols : -1,
+        row > 0 ? index - cols : -1
+    };
+
+    markGeneration++;
+    if (markGeneration == 0) {
+        std::fill(mark.begin(), mark.end(), 0);
+        markGeneration = 1;
+    }
+    int searches = 0;
+    for (int next : neighbors) {
+        if (next >= 0 && !isBlocked(next)) {
+            searchQueue[searches].clear();
+            searchQueue[searches].push_back(next);
+            mark[next] = markGeneration;
+            markSearch[next] = static_cast<uint8_t>(searches);
+            searches++;
+        }
+    }
+    if (searches <= 1) {
+        return; // A dead end or an isolated cell cannot split anything
+    }
+
+    // Searches that meet join one group; each group is still one component
+    int group[4] = {0, 1, 2, 3};
+    bool closed[4] = {false, false, false, false};
+    size_t head[4] = {0, 0, 0, 0};
+    auto groupOf = [&group](int s) {
+        while (group[s] != s) {
+            s = group[s];
+        }
+        return s;
+    };
+    int openGroups = searches;
+
+    while (openGroups > 1) {
+        // One step of every search that still has cells to expand
+        for (int s = 0; s < searches; s++) {
+            if (head[s] >= searchQueue[s].size()) {
+                continue;
+            }
+            int current = searchQueue[s][head[s]++];
+            int currentRow = current / cols;
+            int currentCol = current % cols;
+            int around[4] = {
+                currentCol + 1 < cols ? current + 1 : -1,
+                currentCol > 0 ? current - 1 : -1,
+                currentRow + 1 < rows ? current + cols : -1,
+                currentRow > 0 ? current - cols : -1
+            };
+            for (int next : around) {
+                if (next < 0 || isBlocked(next)) {
+                    continue;
+                }
+                if (mark[next] != markGeneration) {
+                    mark[next] = markGeneration;
+                    markSearch[next] = static_cast<uint8_t>(s);
+                    searchQueue[s].push_back(next);
+                    continue;
+                }
+                int a = groupOf(s), b = groupOf(markSearch[next]);
+                if (a != b) {
+                    group[b] = a;
+                    openGroups--;
+                }
+            }
+        }
+
+        // A group with nothing left to expand is a piece of its own
+        for (int g = 0; g < searches && openGroups > 1; g++) {
+            if (groupOf(g) != g || closed[g]) {
+                continue;
+            }
+            bool exhausted = true;
+            for (int s = 0; s < searches; s++) {
+                if (groupOf(s) == g && head[s] < searchQueue[s].size()) {
+                    exhausted = false;
+                }
+            }
+            if (!exhausted) {
+                continue;
+            }
+            closed[g] = true;
+            openGroups--;
+            int piece = static_cast<int>(labelParent.size());
+            labelParent.push_back(piece);
+            for (int s = 0; s < searches; s++) {
+                if (groupOf(s) == g) {
+                    for (int cell : searchQueue[s]) {
+                        label[cell] = piece;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Scanline labelling: every run of open cells in a row gets a label and is
+// joined with the runs it touches in the row above
+void ComponentLabels::build(const CityGrid &grid) {
+    rows = grid.getRows();
+    cols = grid.getCols();
+    size_t cellCount = grid.cellCount();
+    blockedBits = grid.getBlockedBits();
+    label.assign(cellCount, -1);
+    labelParent.clear();
+    mark.assign(cellCount, 0);
+    markSearch.assign(cellCount, 0);
+    markGeneration = 0;
+
+    for (int row = 0; row < rows; row++) {
+        int rowStart = row * cols;
+        int col = 0;
+        while (col < cols) {
+            if (isBlocked(rowStart + col)) {
+                col++;
+                continue;
+            }
+            int run = static_cast<int>(labelParent.size());
+            labelParent.push_back(run);
+            int previousAbove = -1;
+            for (; col < cols && !isBlocked(rowStart + col); col++) {
+                label[rowStart + col] = run;
+                int above = row > 0 ? label[rowStart + col - cols] : -1;
+                if (above >= 0 && above != previousAbove) {
+                    int root = findRoot(above), own = findRoot(run);
+                    if (root != own) {
+                        labelParent[own] = root;
+                    }
+                }
+                previousAbove = above;
+            }
+        }
+    }
+    flatten();
+    built = true;
+}
+
+void ComponentLabels::sync(const CityGrid &grid) {
+    if (!built || grid.getRows() != rows || grid.getCols() != cols) {
+        build(grid);
+        return;
+    }
+
+    // Apply the changed obstacle cells one at a time; many changes are cheaper as a rebuild
+    const std::vector<uint64_t> &currentBits = grid.getBlockedBits();
+    std::vector<int> changed;
+    size_t rebuildThreshold = grid.cellCount() / 16 + 1;
+    for (size_t word = 0; word < currentBits.size(); word++) {
+        uint64_t diff = currentBits[word] ^ blockedBits[word];
+        while (diff) {
+            int bit = __builtin_ctzll(diff);
+            diff &= diff - 1;
+            changed.push_back(static_cast<int>(word * 64 + bit));
+            if (changed.size() > rebuildThreshold) {
+                build(grid);
+                return;
+            }
+        }
+    }
+    if (changed.empty()) {
+        return;
+    }
+    for (int index : changed) {
+        if ((currentBits[index >> 6] >> (index & 63)) & 1) {
+            blockCell(index);
+        } else {
+            openCell(index);
+        }
+    }
+
+    // Every split and isolated opening adds a label; start over before they outnumber the cells
+    if (labelParent.size() > 2 * grid.cellCount() + 64) {
+        build(grid);
+        return;
+    }
+    flatten();
+}
+
+int ComponentLabels::componentOf(std::pair<int, int> cell) const {
+    int index = cell.first * cols + cell.second;
+    return isBlocked(index) ? -1 : labelParent[label[index]];
+}
+
+bool ComponentLabels::connected(const CityGrid &grid, std::pair<int, int> from, std::pair<int, int> to) const {
+    if (!built || grid.getRows() != rows || grid.getCols() != cols) {
+        return true; // Unknown, let the search decide
+    }
+    if (from == to) {
+        return true;
+    }
+    int target = componentOf(to);
+    if (target < 0) {
+        return false; // The target can never be entered
+    }
+    if (!isBlocked(from.first * cols + from.second)) {
+        return componentOf(from) == target;
+    }
+    int dx[] = {0, 0, 1, -1};
+    int dy[] = {1, -1, 0, 0};
+    for (int d = 0; d < 4; d++) {
+        int row = from.first + dx[d], col = from.second + dy[d];
+        if (row >= 0 && row < rows && col >= 0 && col < cols && componentOf({row, col}) == target) {
+            return true;
+        }
+    }
+    return false;
+}
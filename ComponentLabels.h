@@ -0,0 +1,59 @@
+#ifndef COMPONENT_LABELS_H
+#define COMPONENT_LABELS_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "CityGrid.h"
+
+// Connected-component labels for the passable cells, so "can A reach B"
+// is a label comparison instead of a search. Labels are kept in line with
+// the obstacles incrementally:
+//  - a newly opened cell joins the labels of its open neighbors (union-find
+//    over labels, flattened after every sync so a lookup is one read);
+//  - a newly blocked cell may split its component, so BFS runs from each of
+//    its open neighbors in turn, one cell at a time. Searches that meet are
+//    still connected. A search group that runs out of cells is a closed
+//    piece and gets a new label. The work stops once a single group is
+//    left, so it is bounded by the smaller side of a split.
+class ComponentLabels {
+private:
+    int rows;
+    int cols;
+    bool built;
+    std::vector<uint64_t> blockedBits; // Obstacles the labels were computed for
+    std::vector<int> label;            // Per cell, -1 on obstacles
+    std::vector<int> labelParent;      // Union-find over labels, flat after sync()
+
+    // Split check work space
+    std::vector<uint32_t> mark;      // Cell visited by a split search when stamp == markGeneration
+    std::vector<uint8_t> markSearch; // Which search visited it
+    uint32_t markGeneration;
+    std::vector<int> searchQueue[4];
+
+    bool isBlocked(int index) const { return (blockedBits[index >> 6] >> (index & 63)) & 1; }
+    void setBlockedBit(int index, bool blocked);
+    int findRoot(int l);
+    void openCell(int index);
+    void blockCell(int index);
+    void flatten();
+
+public:
+    ComponentLabels();
+
+    // Label every component from scratch
+    void build(const CityGrid &grid);
+    // Bring the labels in line with the grid, updating only the changed
+    // cells (falls back to build() for large changes or a new grid size)
+    void sync(const CityGrid &grid);
+
+    // Component of an open cell, -1 for obstacles
+    int componentOf(std::pair<int, int> cell) const;
+    // Whether a route from `from` to `to` exists. A blocked `from` can
+    // still drive off through an open neighbor. Answers true while the
+    // labels are not built for this grid size, so callers fall back to searching.
+    bool connected(const CityGrid &grid, std::pair<int, int> from, std::pair<int, int> to) const;
+    bool isBuilt() const { return built; }
+};
+
+#endif // COMPONENT_LABELS_H
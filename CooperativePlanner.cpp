@@ -0,0 +1,387 @@
+#include "CooperativePlanner.h"
+#include <algorithm> // For reverse, min and heap operations
+#include <climits>   // For INT_MAX
+#include <cstdlib>   // For abs
+#include <functional> // For greater
+
+const int CooperativePlanner::UNREACHABLE = INT_MAX / 4;
+
+// ReservationTable definitions
+bool ReservationTable::reserve(int cell, int tick, int agent) {
+    auto holder = parked.find(cell);
+    if (holder != parked.end() && holder->second.first != agent && tick >= holder->second.second) {
+        return false;
+    }
+    auto result = owners.emplace(keyOf(cell, tick), agent);
+    return result.second || result.first->second == agent;
+}
+
+void ReservationTable::release(int cell, int tick, int agent) {
+    auto it = owners.find(keyOf(cell, tick));
+    if (it != owners.end() && it->second == agent) {
+        owners.erase(it);
+    }
+}
+
+bool ReservationTable::park(int cell, int tick, int agent) {
+    auto result = parked.emplace(cell, std::make_pair(agent, tick));
+    if (!result.second && result.first->second.first != agent) {
+        return false;
+    }
+    result.first->second.second = tick;
+    return true;
+}
+
+void ReservationTable::unpark(int cell, int agent) {
+    auto it = parked.find(cell);
+    if (it != parked.end() && it->second.first == agent) {
+        parked.erase(it);
+    }
+}
+
+int ReservationTable::ownerAt(int cell, int tick) const {
+    auto it = owners.find(keyOf(cell, tick));
+    if (it != owners.end()) {
+        return it->second;
+    }
+    auto holder = parked.find(cell);
+    return holder != parked.end() && tick >= holder->second.second ? holder->second.first : -1;
+}
+
+bool ReservationTable::canMove(int from, int to, int tick, int agent) const {
+    int holder = ownerAt(to, tick + 1);
+    if (holder >= 0 && holder != agent) {
+        return false;
+    }
+    if (from != to) {
+        int oncoming = ownerAt(to, tick);
+        if (oncoming >= 0 && oncoming != agent && ownerAt(from, tick + 1) == oncoming) {
+            return false; // The two would pass through each other
+        }
+    }
+    return true;
+}
+
+void ReservationTable::clear() {
+    owners.clear();
+    parked.clear();
+}
+
+size_t ReservationTable::size() const {
+    return owners.size() + parked.size();
+}
+
+// CooperativePlanner definitions
+CooperativePlanner::CooperativePlanner(int windowTicks, int maxExpansionsPerAgent)
+    : grid(nullptr), rows(0), cols(0), window(std::max(2, windowTicks)),
+      maxExpansions(std::max(1, maxExpansionsPerAgent)), tick(0), expanded(0), failedPlans(0) {}
+
+void CooperativePlanner::reset(const CityGrid &cityGrid) {
+    grid = &cityGrid;
+    rows = cityGrid.getRows();
+    cols = cityGrid.getCols();
+    tick = 0;
+    agents.clear();
+    reservations.clear();
+    expanded = 0;
+    failedPlans = 0;
+}
+
+void CooperativePlanner::resetReverseSearch(Agent &agent) {
+    agent.reverseClosed.clear();
+    agent.reverseOpenG.clear();
+    agent.reverseHeap.clear();
+    if (grid->isPassable(agent.goal)) {
+        agent.reverseOpenG[agent.goal] = 0;
+        int h = std::abs(agent.goal / cols - agent.origin / cols) + std::abs(agent.goal % cols - agent.origin % cols);
+        agent.reverseHeap.push_back({h, agent.goal});
+    }
+}
+
+// Road distance from `cell` to the agent's goal, resuming the reverse search
+// until the cell is closed. A blocked cell (the start) is left through its
+// best open neighbor.
+int CooperativePlanner::trueDistance(Agent &agent, int cell) {
+    int row = cell / cols;
+    int col = cell % cols;
+    int neighbors[4] = {
+        col + 1 < cols ? cell + 1 : -1,
+        col > 0 ? cell - 1 : -1,
+        row + 1 < rows ? cell + cols : -1,
+        row > 0 ? cell - cols : -1
+    };
+    if (!grid->isPassable(cell)) {
+        int best = UNREACHABLE;
+        for (int next : neighbors) {
+            if (next >= 0 && grid->isPassable(next)) {
+                best = std::min(best, trueDistance(agent, next) + 1);
+            }
+        }
+        return best;
+    }
+    auto found = agent.reverseClosed.find(cell);
+    if (found != agent.reverseClosed.end()) {
+        return found->second;
+    }
+
+    auto heapGreater = std::greater<std::pair<int, int>>();
+    while (!agent.reverseHeap.empty()) {
+        std::pop_heap(agent.reverseHeap.begin(), agent.reverseHeap.end(), heapGreater);
+        int current = agent.reverseHeap.back().second;
+        agent.reverseHeap.pop_back();
+        auto open = agent.reverseOpenG.find(current);
+        if (open == agent.reverseOpenG.end()) {
+            continue; // Already closed
+        }
+        int g = open->second;
+        agent.reverseOpenG.erase(open);
+        agent.reverseClosed[current] = g;
+
+        int currentRow = current / cols;
+        int currentCol = current % cols;
+        int around[4] = {
+            currentCol + 1 < cols ? current + 1 : -1,
+            currentCol > 0 ? current - 1 : -1,
+            currentRow + 1 < rows ? current + cols : -1,
+            currentRow > 0 ? current - cols : -1
+        };
+        for (int next : around) {
+            if (next < 0 || !grid->isPassable(next) || agent.reverseClosed.count(next)) {
+                continue;
+            }
+            auto it = agent.reverseOpenG.find(next);
+            if (it != agent.reverseOpenG.end() && it->second <= g + 1) {
+                continue;
+            }
+            agent.reverseOpenG[next] = g + 1;
+            int h = std::abs(next / cols - agent.origin / cols) + std::abs(next % cols - agent.origin % cols);
+            agent.reverseHeap.push_back({g + 1 + h, next});
+            std::push_heap(agent.reverseHeap.begin(), agent.reverseHeap.end(), heapGreater);
+        }
+        if (current == cell) {
+            return g;
+        }
+    }
+    return UNREACHABLE;
+}
+
+// Free every tick of the agent's plan and the cell it parks on after it
+void CooperativePlanner::releasePlan(int id) {
+    Agent &agent = agents[id];
+    for (size_t i = 0; i < agent.plan.size(); i++) {
+        reservations.release(agent.plan[i], agent.planStart + static_cast<int>(i), id);
+    }
+    if (!agent.plan.empty()) {
+        reservations.unpark(agent.plan.back(), id);
+    }
+}
+
+// Reserve every tick of the agent's plan and park on its last cell;
+// on failure nothing stays reserved
+bool CooperativePlanner::reservePlan(int id) {
+    Agent &agent = agents[id];
+    int last = agent.planStart + static_cast<int>(agent.plan.size()) - 1;
+    for (size_t i = 0; i < agent.plan.size(); i++) {
+        if (!reservations.reserve(agent.plan[i], agent.planStart + static_cast<int>(i), id)) {
+            for (size_t j = 0; j < i; j++) {
+                reservations.release(agent.plan[j], agent.planStart + static_cast<int>(j), id);
+            }
+            return false;
+        }
+    }
+    if (!reservations.park(agent.plan.back(), last, id)) {
+        releasePlan(id);
+        return false;
+    }
+    return true;
+}
+
+// Whether no other agent holds the cell during [fromTick, toTick]
+bool CooperativePlanner::cellFree(int id, int cell, int fromTick, int toTick) const {
+    for (int t = fromTick; t <= toTick; t++) {
+        int holder = reservations.ownerAt(cell, t);
+        if (holder >= 0 && holder != id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Space-time A* over the next `window` ticks, then reserve the result.
+// The plan must end on a cell no other agent holds up to the horizon (plans
+// reach no further), since the agent stays parked there afterwards.
+void CooperativePlanner::planWindow(int id) {
+    Agent &agent = agents[id];
+    int horizon = tick + window;
+    // What is left of the current plan, kept if the new one fails
+    int offset = std::min(tick - agent.planStart, static_cast<int>(agent.plan.size()) - 1);
+    std::vector<int> previous(agent.plan.begin() + offset, agent.plan.end());
+    releasePlan(id);
+    searchNodes.clear();
+    searchIndex.clear();
+    openHeap.clear();
+    auto keyOf = [](int cell, int t) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(t)) << 32) | static_cast<uint32_t>(cell);
+    };
+    auto heapGreater = std::greater<std::pair<int, int>>();
+
+    searchNodes.push_back({agent.cell, tick, 0, trueDistance(agent, agent.cell), -1});
+    searchIndex[keyOf(agent.cell, tick)] = 0;
+    openHeap.push_back({searchNodes[0].h, 0});
+    int terminal = -1, fallback = -1, expansions = 0;
+
+    while (!openHeap.empty() && expansions < maxExpansions) {
+        std::pop_heap(openHeap.begin(), openHeap.end(), heapGreater);
+        int index = openHeap.back().second;
+        openHeap.pop_back();
+        SearchNode node = searchNodes[index];
+        if (searchIndex[keyOf(node.cell, node.tick)] != index) {
+            continue; // A cheaper node replaced it
+        }
+        expansions++;
+        bool safe = cellFree(id, node.cell, node.tick + 1, horizon);
+        if (safe && (node.tick == horizon || node.cell == agent.goal)) {
+            terminal = index;
+            break;
+        }
+        if (safe && (fallback < 0 || node.h < searchNodes[fallback].h ||
+                     (node.h == searchNodes[fallback].h && node.tick > searchNodes[fallback].tick))) {
+            fallback = index;
+        }
+
+        int row = node.cell / cols;
+        int col = node.cell % cols;
+        // Waiting first, then right, left, down, up
+        int moves[5] = {
+            node.cell,
+            col + 1 < cols ? node.cell + 1 : -1,
+            col > 0 ? node.cell - 1 : -1,
+            row + 1 < rows ? node.cell + cols : -1,
+            row > 0 ? node.cell - cols : -1
+        };
+        for (int next : moves) {
+            if (next < 0 || (next != node.cell && !grid->isPassable(next)) ||
+                !reservations.canMove(node.cell, next, node.tick, id)) {
+                continue;
+            }
+            int h = trueDistance(agent, next);
+            if (h >= UNREACHABLE) {
+                continue;
+            }
+            int g = node.g + 1;
+            uint64_t key = keyOf(next, node.tick + 1);
+            auto it = searchIndex.find(key);
+            if (it != searchIndex.end() && searchNodes[it->second].g <= g) {
+                continue;
+            }
+            int created = static_cast<int>(searchNodes.size());
+            searchNodes.push_back({next, node.tick + 1, g, h, index});
+            searchIndex[key] = created;
+            openHeap.push_back({g + h, created});
+            std::push_heap(openHeap.begin(), openHeap.end(), heapGreater);
+        }
+    }
+    expanded += expansions;
+    if (terminal < 0) {
+        terminal = fallback; // Follow the most promising partial route instead
+    }
+
+    agent.plan.clear();
+    for (int at = terminal; at >= 0; at = searchNodes[at].parent) {
+        agent.plan.push_back(searchNodes[at].cell);
+    }
+    std::reverse(agent.plan.begin(), agent.plan.end());
+    agent.planStart = tick;
+    if (terminal >= 0 && reservePlan(id)) {
+        return;
+    }
+    // Nowhere safe to stop, or the plan could not be reserved: keep the old
+    // one, which nobody else has claimed in the meantime
+    failedPlans++;
+    agent.plan = previous;
+    reservePlan(id);
+}
+
+int CooperativePlanner::addAgent(std::pair<int, int> start, std::pair<int, int> goal) {
+    int id = static_cast<int>(agents.size());
+    agents.emplace_back();
+    Agent &agent = agents.back();
+    agent.active = true;
+    agent.cell = start.first * cols + start.second;
+    agent.goal = goal.first * cols + goal.second;
+    agent.origin = agent.cell;
+    agent.plan.assign(1, agent.cell);
+    agent.planStart = tick;
+    resetReverseSearch(agent);
+    reservePlan(id);
+    return id;
+}
+
+// A new goal replans the agent right away; its current plan stays if that fails
+void CooperativePlanner::setGoal(int id, std::pair<int, int> goal) {
+    Agent &agent = agents[id];
+    agent.goal = goal.first * cols + goal.second;
+    agent.origin = agent.cell;
+    resetReverseSearch(agent);
+    planWindow(id);
+}
+
+void CooperativePlanner::removeAgent(int id) {
+    Agent &agent = agents[id];
+    releasePlan(id);
+    agent.active = false;
+    agent.plan.clear();
+    agent.reverseClosed.clear();
+    agent.reverseOpenG.clear();
+    agent.reverseHeap.clear();
+}
+
+void CooperativePlanner::step() {
+    expanded = 0;
+    int count = static_cast<int>(agents.size());
+    std::vector<int> due;
+    for (int k = 0; k < count; k++) {
+        int id = (tick + k) % count; // Rotate who plans first
+        const Agent &agent = agents[id];
+        bool finished = tick + 1 >= agent.planStart + static_cast<int>(agent.plan.size());
+        if (agent.active && !(finished && agent.cell == agent.goal) &&
+            (finished || tick >= agent.planStart + window / 2)) {
+            due.push_back(id);
+        }
+    }
+    for (int id : due) {
+        planWindow(id);
+    }
+
+    tick++;
+    for (Agent &agent : agents) {
+        if (agent.active) {
+            int offset = std::min(tick - agent.planStart, static_cast<int>(agent.plan.size()) - 1);
+            agent.cell = agent.plan[offset]; // Parked on the last cell once the plan runs out
+        }
+    }
+}
+
+std::pair<int, int> CooperativePlanner::positionOf(int id) const {
+    return {agents[id].cell / cols, agents[id].cell % cols};
+}
+
+bool CooperativePlanner::atGoal(int id) const {
+    return agents[id].cell == agents[id].goal;
+}
+
+int CooperativePlanner::currentTick() const {
+    return tick;
+}
+
+int CooperativePlanner::lastExpandedCount() const {
+    return expanded;
+}
+
+int CooperativePlanner::failedPlanCount() const {
+    return failedPlans;
+}
+
+size_t CooperativePlanner::reservationCount() const {
+    return reservations.size();
+}
@@ -0,0 +1,126 @@
+#ifndef COOPERATIVE_PLANNER_H
+#define COOPERATIVE_PLANNER_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include "CityGrid.h"
+
+// Hashed space-time reservation table: which agent holds a cell at a tick.
+// An agent can also park on a cell, holding it from a tick on until it
+// unparks, so a plan's last cell stays held after the plan runs out.
+class ReservationTable {
+private:
+    std::unordered_map<uint64_t, int> owners; // (tick, cell) -> agent
+    std::unordered_map<int, std::pair<int, int>> parked; // cell -> (agent, from tick)
+
+    static uint64_t keyOf(int cell, int tick) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(tick)) << 32) | static_cast<uint32_t>(cell);
+    }
+
+public:
+    // False if another agent already holds the cell at that tick
+    bool reserve(int cell, int tick, int agent);
+    void release(int cell, int tick, int agent);
+    // False if another agent is parked there
+    bool park(int cell, int tick, int agent);
+    void unpark(int cell, int agent);
+    int ownerAt(int cell, int tick) const; // -1 if free
+    // Whether `agent` may step from `from` to `to` between `tick` and tick + 1:
+    // the cell is free then and no other agent makes the opposite move
+    bool canMove(int from, int to, int tick, int agent) const;
+    void clear();
+    size_t size() const;
+};
+
+// Cooperative path-finding for many drivers sharing the roads
+// (Windowed Hierarchical Cooperative A*, Silver 2005).
+// Each agent searches space-time, where waiting in place is a move, and
+// only steps through (cell, tick) pairs the table does not hold for others.
+// It then reserves its own path, so agents that plan later route around
+// it, and no two agents hold a cell or swap cells on the same tick.
+// Per-agent cost stays bounded:
+//  - a search looks only `window` ticks ahead and expands at most
+//    `maxExpansions` nodes; beyond the window the agent is guided by its
+//    true road distance to the goal;
+//  - that distance comes from a reverse A* from the goal that is resumed
+//    only when an unseen cell is asked for (Reverse Resumable A*), so each
+//    cell's distance is found once per goal;
+//  - agents replan every window / 2 ticks, staggered, so priorities rotate.
+// A plan only ends on a cell nobody else holds after it, and the agent
+// stays parked there until it replans. If no such plan exists, or part of
+// it cannot be reserved, the search counts as failed and the agent keeps
+// its previous plan. An agent that reaches its goal stops replanning and
+// holds the cell for good, so the others route around it.
+class CooperativePlanner {
+private:
+    struct Agent {
+        bool active;
+        int cell;
+        int goal;
+        int origin;             // Cell the reverse search is aimed at
+        std::vector<int> plan;  // Cell at each tick from planStart on
+        int planStart;
+        // Reverse Resumable A* from the goal
+        std::unordered_map<int, int> reverseClosed; // Exact road distance to the goal
+        std::unordered_map<int, int> reverseOpenG;
+        std::vector<std::pair<int, int>> reverseHeap; // (g + heuristic, cell)
+    };
+    struct SearchNode {
+        int cell;
+        int tick;
+        int g;
+        int h;
+        int parent; // Index into searchNodes, -1 at the start
+    };
+
+    const CityGrid *grid;
+    int rows;
+    int cols;
+    int window;
+    int maxExpansions;
+    int tick;
+    std::vector<Agent> agents;
+    ReservationTable reservations;
+
+    // Space-time search scratch
+    std::vector<SearchNode> searchNodes;
+    std::unordered_map<uint64_t, int> searchIndex; // (tick, cell) -> best node
+    std::vector<std::pair<int, int>> openHeap;     // (f, node)
+    int expanded;
+    int failedPlans;
+
+    int trueDistance(Agent &agent, int cell);
+    void resetReverseSearch(Agent &agent);
+    void releasePlan(int id);
+    void planWindow(int id);
+    bool reservePlan(int id);
+    bool cellFree(int id, int cell, int fromTick, int toTick) const;
+
+public:
+    static const int UNREACHABLE;
+
+    explicit CooperativePlanner(int windowTicks = 16, int maxExpansionsPerAgent = 1024);
+
+    // Drop every agent and reservation and plan on `cityGrid` from tick 0
+    void reset(const CityGrid &cityGrid);
+    // New agent standing at `start`; returns its id
+    int addAgent(std::pair<int, int> start, std::pair<int, int> goal);
+    void setGoal(int id, std::pair<int, int> goal);
+    // The agent leaves the roads and frees its reservations
+    void removeAgent(int id);
+
+    // Replan the agents that are due, then move every agent one tick
+    void step();
+
+    std::pair<int, int> positionOf(int id) const;
+    bool atGoal(int id) const;
+    int currentTick() const;
+    int lastExpandedCount() const;  // Space-time nodes expanded by the last step()
+    int failedPlanCount() const;    // Searches that found no plan to keep so far
+    size_t reservationCount() const;
+};
+
+#endif // COOPERATIVE_PLANNER_H
@@ -0,0 +1,230 @@
+#include "DStarLite.h"
+#include <algorithm> // For min and heap operations
+#include <climits>   // For INT_MAX
+#include <cstdlib>   // For abs
+
+const int DStarLite::INF = INT_MAX / 4; // Leaves room for adding costs and keys
+
+// Ordering for the open list: smallest key on top
+static bool openItemLess(const DStarKey &a, const DStarKey &b) {
+    return b < a;
+}
+
+DStarLite::DStarLite()
+    : grid(nullptr), minCost(1), rows(0), cols(0), start(-1), goal(-1), km(0), expanded(0) {}
+
+DStarLite::Node &DStarLite::nodeAt(int cell) {
+    auto it = nodes.find(cell);
+    if (it == nodes.end()) {
+        it = nodes.emplace(cell, Node{INF, INF, {INF, INF}, false}).first;
+    }
+    return it->second;
+}
+
+int DStarLite::gOf(int cell) const {
+    auto it = nodes.find(cell);
+    return it == nodes.end() ? INF : it->second.g;
+}
+
+int DStarLite::stepCost(int cell) const {
+    return grid->isPassable(cell) ? grid->traversalCost(cell, costs) : INF;
+}
+
+// Manhattan distance times the cheapest step never overestimates
+int DStarLite::heuristic(int a, int b) const {
+    return (std::abs(a / cols - b / cols) + std::abs(a % cols - b % cols)) * minCost;
+}
+
+DStarKey DStarLite::calculateKey(int cell, const Node &node) const {
+    int best = std::min(node.g, node.rhs);
+    if (best >= INF) {
+        return {INF, INF};
+    }
+    return {best + heuristic(start, cell) + km, best};
+}
+
+// Same neighbor order as the other grid searches: right, left, down, up
+int DStarLite::neighborsOf(int cell, int out[4]) const {
+    int row = cell / cols;
+    int col = cell % cols;
+    int count = 0;
+    if (col + 1 < cols) out[count++] = cell + 1;
+    if (col > 0) out[count++] = cell - 1;
+    if (row + 1 < rows) out[count++] = cell + cols;
+    if (row > 0) out[count++] = cell - cols;
+    return count;
+}
+
+// Recompute a cell's one-step lookahead and queue it if it is inconsistent.
+// Queued entries are never removed in place; an entry whose key no longer
+// matches the node is skipped when it reaches the top.
+void DStarLite::updateVertex(int cell) {
+    Node &node = nodeAt(cell);
+    if (cell != goal) {
+        int best = INF;
+        int neighbors[4];
+        int count = neighborsOf(cell, neighbors);
+        for (int i = 0; i < count; i++) {
+            int cost = stepCost(neighbors[i]);
+            int g = gOf(neighbors[i]);
+            if (cost < INF && g < INF && cost + g < best) {
+                best = cost + g;
+            }
+        }
+        node.rhs = best;
+    }
+    if (node.g != node.rhs) {
+        node.key = calculateKey(cell, node);
+        node.queued = true;
+        openHeap.push_back({node.key, cell});
+        std::push_heap(openHeap.begin(), openHeap.end(),
+                       [](const OpenItem &a, const OpenItem &b) { return openItemLess(a.key, b.key); });
+    } else {
+        node.queued = false;
+    }
+}
+
+bool DStarLite::topKey(DStarKey &key) {
+    auto less = [](const OpenItem &a, const OpenItem &b) { return openItemLess(a.key, b.key); };
+    while (!openHeap.empty()) {
+        const OpenItem &top = openHeap.front();
+        auto it = nodes.find(top.cell);
+        if (it != nodes.end() && it->second.queued && it->second.key == top.key) {
+            key = top.key;
+            return true;
+        }
+        std::pop_heap(openHeap.begin(), openHeap.end(), less);
+        openHeap.pop_back(); // Stale entry
+    }
+    return false;
+}
+
+void DStarLite::reset(const CityGrid &cityGrid, std::pair<int, int> startCell, std::pair<int, int> goalCell,
+                      const TraversalCosts &traversalCosts) {
+    grid = &cityGrid;
+    costs = traversalCosts;
+    minCost = std::max(1, std::min(costs.road, std::min(costs.trafficSignal, costs.congestionZone)));
+    rows = cityGrid.getRows();
+    cols = cityGrid.getCols();
+    start = startCell.first * cols + startCell.second;
+    goal = goalCell.first * cols + goalCell.second;
+    km = 0;
+    nodes.clear();
+    openHeap.clear();
+    expanded = 0;
+
+    Node &goalNode = nodeAt(goal);
+    goalNode.rhs = 0;
+    goalNode.key = calculateKey(goal, goalNode);
+    goalNode.queued = true;
+    openHeap.push_back({goalNode.key, goal});
+}
+
+// ComputeShortestPath: expand until the start is consistent and no queued
+// cell could still lower its cost
+bool DStarLite::plan() {
+    auto less = [](const OpenItem &a, const OpenItem &b) { return openItemLess(a.key, b.key); };
+    expanded = 0;
+    DStarKey oldKey;
+    while (topKey(oldKey)) {
+        Node &startNode = nodeAt(start);
+        if (!(oldKey < calculateKey(start, startNode)) && startNode.rhs == startNode.g) {
+            break;
+        }
+        int cell = openHeap.front().cell;
+        std::pop_heap(openHeap.begin(), openHeap.end(), less);
+        openHeap.pop_back();
+
+        Node &node = nodeAt(cell);
+        node.queued = false;
+        DStarKey newKey = calculateKey(cell, node);
+        if (oldKey < newKey) { // Key went up after km grew, requeue
+            node.key = newKey;
+            node.queued = true;
+            openHeap.push_back({newKey, cell});
+            std::push_heap(openHeap.begin(), openHeap.end(), less);
+            continue;
+        }
+
+        expanded++;
+        int neighbors[4];
+        int count = neighborsOf(cell, neighbors);
+        if (node.g > node.rhs) { // Overconsistent: settle the lower cost
+            node.g = node.rhs;
+        } else {                 // Underconsistent: forget the cost and re-derive it
+            node.g = INF;
+            updateVertex(cell);
+        }
+        for (int i = 0; i < count; i++) {
+            updateVertex(neighbors[i]);
+        }
+    }
+    return pathCost() < INF;
+}
+
+void DStarLite::moveStart(std::pair<int, int> startCell) {
+    int cell = startCell.first * cols + startCell.second;
+    km += heuristic(start, cell);
+    start = cell;
+}
+
+// Entering `cell` got cheaper, dearer or impossible, so only the cells that
+// step into it (its neighbors) need their lookahead recomputed
+bool DStarLite::cellChanged(std::pair<int, int> cell) {
+    int index = cell.first * cols + cell.second;
+    bool affected = false;
+    int neighbors[4];
+    int count = neighborsOf(index, neighbors);
+    for (int i = 0; i < count; i++) {
+        auto it = nodes.find(neighbors[i]);
+        if (it == nodes.end()) {
+            continue; // Never reached by the search, nothing depends on it
+        }
+        updateVertex(neighbors[i]);
+        affected = affected || nodes[neighbors[i]].queued;
+    }
+    return affected;
+}
+
+// Follow the cheapest lookahead from the start to the goal
+bool DStarLite::extractPath(std::vector<std::pair<int, int>> &path) const {
+    path.clear();
+    if (pathCost() >= INF) {
+        return false;
+    }
+    int cell = start;
+    path.push_back({cell / cols, cell % cols});
+    while (cell != goal) {
+        int best = -1, bestCost = INF;
+        int neighbors[4];
+        int count = neighborsOf(cell, neighbors);
+        for (int i = 0; i < count; i++) {
+            int cost = stepCost(neighbors[i]);
+            int g = gOf(neighbors[i]);
+            if (cost < INF && g < INF && cost + g < bestCost) {
+                bestCost = cost + g;
+                best = neighbors[i];
+            }
+        }
+        if (best < 0 || path.size() > nodes.size()) {
+            path.clear(); // Search state is out of date
+            return false;
+        }
+        cell = best;
+        path.push_back({cell / cols, cell % cols});
+    }
+    return true;
+}
+
+int DStarLite::pathCost() const {
+    auto it = nodes.find(start);
+    return it == nodes.end() ? INF : std::min(it->second.g, it->second.rhs);
+}
+
+int DStarLite::lastExpandedCount() const {
+    return expanded;
+}
+
+size_t DStarLite::stateSize() const {
+    return nodes.size();
+}
@@ -0,0 +1,87 @@
+#ifndef DSTAR_LITE_H
+#define DSTAR_LITE_H
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include "CityGrid.h"
+
+// Priority of a cell in the D* Lite open list, compared lexicographically
+struct DStarKey {
+    int primary;   // min(g, rhs) + heuristic + km
+    int secondary; // min(g, rhs)
+
+    bool operator<(const DStarKey &other) const {
+        return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+    }
+    bool operator==(const DStarKey &other) const {
+        return primary == other.primary && secondary == other.secondary;
+    }
+};
+
+// Incremental route planner for one ride (D* Lite, Koenig & Likhachev).
+// The search runs backwards from the goal, so every explored cell knows its
+// cost to the goal. When cells open, close or change cost, only the cells
+// whose cost-to-goal depended on them are re-expanded, and a driver that
+// has moved does not invalidate the search. Entering a cell costs
+// CityGrid::traversalCost under the costs given to reset().
+// Search state is kept per touched cell in a hash map, so a ride only pays
+// for the part of the map its searches explored.
+class DStarLite {
+private:
+    struct Node {
+        int g;
+        int rhs;
+        DStarKey key; // Key of the live open list entry
+        bool queued;
+    };
+    struct OpenItem {
+        DStarKey key;
+        int cell;
+    };
+
+    const CityGrid *grid;
+    TraversalCosts costs;
+    int minCost; // Cheapest step, scales the heuristic
+    int rows;
+    int cols;
+    int start;
+    int goal;
+    int km; // Heuristic offset accumulated as the start moves
+    std::unordered_map<int, Node> nodes;
+    std::vector<OpenItem> openHeap;
+    int expanded;
+
+    Node &nodeAt(int cell);
+    int gOf(int cell) const;
+    int stepCost(int cell) const; // Cost of entering `cell`, INF if blocked
+    int heuristic(int a, int b) const;
+    DStarKey calculateKey(int cell, const Node &node) const;
+    void updateVertex(int cell);
+    bool topKey(DStarKey &key); // Drops stale entries, false if the list is empty
+    int neighborsOf(int cell, int out[4]) const;
+
+public:
+    static const int INF;
+
+    DStarLite();
+
+    // Start a new plan; the previous search state is dropped
+    void reset(const CityGrid &cityGrid, std::pair<int, int> startCell, std::pair<int, int> goalCell,
+               const TraversalCosts &traversalCosts);
+    // Bring the search up to date, returns false if the goal is unreachable
+    bool plan();
+    // The driver moved, the search state stays valid
+    void moveStart(std::pair<int, int> startCell);
+    // A cell was blocked, opened or changed cost in the grid.
+    // Returns true if the change touches cells this search depends on.
+    bool cellChanged(std::pair<int, int> cell);
+    // Route from the start to the goal (both included) after plan()
+    bool extractPath(std::vector<std::pair<int, int>> &path) const;
+
+    int pathCost() const;          // Cost from the start to the goal, INF if unreachable
+    int lastExpandedCount() const; // Cells expanded by the last plan()
+    size_t stateSize() const;      // Cells holding search state
+};
+
+#endif // DSTAR_LITE_H
@@ -0,0 +1,79 @@
+#include "EntityPlacer.h"
+#include <algorithm> // For min and swap
+
+EntityPlacer::EntityPlacer(int gridRows, int gridCols, uint64_t seed) : rows(0), cols(0), occupiedCount(0), rng(seed) {
+    reset(gridRows, gridCols, seed);
+}
+
+void EntityPlacer::reset(int gridRows, int gridCols, uint64_t seed) {
+    rows = gridRows;
+    cols = gridCols;
+    occupied.assign((static_cast<size_t>(rows) * cols + 63) / 64, 0);
+    occupiedCount = 0;
+    rng.reseed(seed);
+}
+
+void EntityPlacer::markCell(size_t index) {
+    if (!testCell(index)) {
+        occupied[index >> 6] |= uint64_t(1) << (index & 63);
+        occupiedCount++;
+    }
+}
+
+void EntityPlacer::reserve(std::pair<int, int> cell) {
+    markCell(static_cast<size_t>(cell.first) * cols + cell.second);
+}
+
+bool EntityPlacer::isOccupied(std::pair<int, int> cell) const {
+    return testCell(static_cast<size_t>(cell.first) * cols + cell.second);
+}
+
+size_t EntityPlacer::freeCount() const {
+    return static_cast<size_t>(rows) * cols - occupiedCount;
+}
+
+void EntityPlacer::place(std::vector<std::pair<int, int>> &positions, size_t count) {
+    for (auto &pos : positions) {
+        reserve(pos);
+    }
+    if (positions.size() >= count) {
+        return;
+    }
+    size_t needed = std::min(count - positions.size(), freeCount());
+
+    // Retrying is expected O(1) per cell while at least half of the free
+    // cells stay free; past that, draw from the explicit free list
+    if (needed * 2 > freeCount()) {
+        sampleWithoutReplacement(positions, needed);
+        return;
+    }
+    size_t cellCount = static_cast<size_t>(rows) * cols;
+    while (needed > 0) {
+        size_t index = rng.nextBelow(cellCount);
+        if (testCell(index)) {
+            continue;
+        }
+        markCell(index);
+        positions.push_back({static_cast<int>(index / cols), static_cast<int>(index % cols)});
+        needed--;
+    }
+}
+
+// Partial Fisher-Yates shuffle over the free cells
+void EntityPlacer::sampleWithoutReplacement(std::vector<std::pair<int, int>> &positions, size_t count) {
+    freeCells.clear();
+    size_t cellCount = static_cast<size_t>(rows) * cols;
+    for (size_t index = 0; index < cellCount; index++) {
+        if (!testCell(index)) {
+            freeCells.push_back(static_cast<int>(index));
+        }
+    }
+    count = std::min(count, freeCells.size());
+    for (size_t i = 0; i < count; i++) {
+        size_t pick = i + rng.nextBelow(freeCells.size() - i);
+        std::swap(freeCells[i], freeCells[pick]);
+        int index = freeCells[i];
+        markCell(index);
+        positions.push_back({index / cols, index % cols});
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef ENTITY_PLACER_H
+#define ENTITY_PLACER_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "FastRandom.h"
+
+// Places entities on distinct random cells.
+// Occupied cells are tracked in a bitset, so checking a candidate is O(1)
+// and a cell is never handed out twice across all the entity kinds placed
+// with the same placer. While few cells are taken, random draws are simply
+// retried on occupied cells. A request that would fill most of the remaining
+// space samples without replacement from the list of free cells instead, so
+// placement stays linear in the grid size however full the grid gets.
+// The layout depends only on the seed and the sequence of calls.
+class EntityPlacer {
+private:
+    int rows;
+    int cols;
+    std::vector<uint64_t> occupied;
+    size_t occupiedCount;
+    FastRandom rng;
+    std::vector<int> freeCells; // Scratch list for sampling without replacement
+
+    bool testCell(size_t index) const { return (occupied[index >> 6] >> (index & 63)) & 1; }
+    void markCell(size_t index);
+
+public:
+    EntityPlacer(int gridRows, int gridCols, uint64_t seed);
+
+    void reset(int gridRows, int gridCols, uint64_t seed);
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+
+    void reserve(std::pair<int, int> cell); // Keep a cell out of future placements
+    bool isOccupied(std::pair<int, int> cell) const;
+    size_t freeCount() const;
+
+    // Append distinct free cells to `positions` until it holds `count`
+    // entries (or the grid is full). Cells already in `positions` are reserved first.
+    void place(std::vector<std::pair<int, int>> &positions, size_t count);
+    // Append `count` cells chosen by sampling without replacement
+    void sampleWithoutReplacement(std::vector<std::pair<int, int>> &positions, size_t count);
+};
+
+#endif // ENTITY_PLACER_H
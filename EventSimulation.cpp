@@ -0,0 +1,353 @@
+#include "EventSimulation.h"
+#include "Location_Tracking.h"
+#include <algorithm> // For sort and set_symmetric_difference
+#include <iterator>  // For back_inserter
+
+// Comparator for Min-Heap: earliest event first, ties in scheduling order
+bool CompareEvent::operator()(const SimEvent& a, const SimEvent& b) const {
+    if (a.time != b.time) {
+        return a.time > b.time;
+    }
+    return a.seq > b.seq;
+}
+
+EventSimulator::EventSimulator(SimulationWorld &simulationWorld)
+    : world(simulationWorld), clock(0.0), nextSeq(0), processedEvents(0), seenLayoutVersion(simulationWorld.layoutVersion),
+      renderInterval(0.0), nextRenderTime(0.0) {
+    seenLayers[0] = world.layout.obstacles;
+    seenLayers[1] = world.layout.trafficSignals;
+    seenLayers[2] = world.layout.congestionZones;
+    for (auto &layer : seenLayers) {
+        std::sort(layer.begin(), layer.end());
+    }
+}
+
+EventSimulator::EventSimulator() : EventSimulator(mainWorld) {}
+
+// Push an event onto the queue
+void EventSimulator::schedule(double time, SimEventType type, int driverIndex) {
+    events.push({time, nextSeq++, type, driverIndex});
+    if (type == SimEventType::DriverMove) {
+        rides[driverIndex].movePending = true;
+    }
+}
+
+// Every cell costs one step
+static TraversalCosts unitCosts() {
+    TraversalCosts unit;
+    unit.trafficSignal = unit.road;
+    unit.congestionZone = unit.road;
+    return unit;
+}
+
+// Costs the ride planners use: unit steps unless the weighted engine is selected
+static TraversalCosts routingCosts(const SimulationWorld &world) {
+    return world.pathEngine == PathEngine::Weighted ? world.traversalCosts : unitCosts();
+}
+
+// Where the current leg of a ride ends: the next refuel stop, or the target
+static std::pair<int, int> legTarget(const ActiveRide &ride) {
+    return ride.nextStop < ride.refuelStops.size() ? ride.refuelStops[ride.nextStop] : ride.target;
+}
+
+// Encode routeCells into the ride and put the driver at its start
+bool EventSimulator::storeRoute(ActiveRide &ride) {
+    if (!ride.path.assign(routeCells)) {
+        return false;
+    }
+    ride.position = ride.path.begin();
+    return true;
+}
+
+// Whether the driver's tank covers the rest of the current leg
+bool EventSimulator::hasFuelFor(int driverIndex) const {
+    const ActiveRide &ride = rides[driverIndex];
+    int remaining = static_cast<int>(ride.path.size() - 1 - ride.position.index);
+    return remaining == 0 || remaining <= world.driverFuel[driverIndex];
+}
+
+bool EventSimulator::atRefuelStop(int driverIndex) const {
+    const ActiveRide &ride = rides[driverIndex];
+    return ride.nextStop < ride.refuelStops.size() && world.driverPos[driverIndex] == ride.refuelStops[ride.nextStop];
+}
+
+// Route the rest of the ride through fuel stations and drive the fuel
+// route's first leg, which fits the tank as planned
+bool EventSimulator::planRefuelStops(int driverIndex) {
+    ActiveRide &ride = rides[driverIndex];
+    if (!findFuelRoute(world, world.driverPos[driverIndex], ride.target, world.driverFuel[driverIndex], fuelRoute)) {
+        return false;
+    }
+    ride.refuelStops = fuelRoute.refuelStops;
+    ride.nextStop = 0;
+    ride.planner.reset(); // Its goal was the old leg's end
+    std::pair<int, int> stop = legTarget(ride);
+    size_t legEnd = 0;
+    while (legEnd < fuelRoute.path.size() && fuelRoute.path[legEnd] != stop) {
+        legEnd++;
+    }
+    if (legEnd == fuelRoute.path.size()) {
+        ride.refuelStops.clear(); // The route misses its own stop, so there is no leg to drive
+        return false;
+    }
+    routeCells.assign(fuelRoute.path.begin(), fuelRoute.path.begin() + legEnd + 1);
+    return storeRoute(ride) && hasFuelFor(driverIndex);
+}
+
+// Compute a fresh route to the end of the current leg with the world's engine
+bool EventSimulator::planRoute(int driverIndex) {
+    ActiveRide &ride = rides[driverIndex];
+    ride.replanNeeded = false;
+    ride.planner.reset(); // Built again by the first map change that matters
+    if (!findShortestPath(world, world.driverPos[driverIndex], legTarget(ride), routeCells) || !storeRoute(ride)) {
+        return false;
+    }
+    return hasFuelFor(driverIndex) || planRefuelStops(driverIndex);
+}
+
+// Repair the route from the driver's current position after a map change.
+// The first repair of a leg starts a D* Lite search; later ones reuse it.
+bool EventSimulator::replanRoute(int driverIndex) {
+    ActiveRide &ride = rides[driverIndex];
+    ride.replanNeeded = false;
+    if (ride.planner) {
+        ride.planner->moveStart(world.driverPos[driverIndex]);
+    } else {
+        bool refuelLeg = ride.nextStop < ride.refuelStops.size(); // Legs to a stop are planned in steps
+        ride.planner.reset(new DStarLite());
+        ride.planner->reset(world.grid, world.driverPos[driverIndex], legTarget(ride),
+                            refuelLeg ? unitCosts() : routingCosts(world));
+    }
+    if (!ride.planner->plan() || !ride.planner->extractPath(routeCells) || !storeRoute(ride)) {
+        return false;
+    }
+    return hasFuelFor(driverIndex) || planRefuelStops(driverIndex); // A detour may outrun the tank
+}
+
+// Send a driver towards a target cell
+bool EventSimulator::dispatchRide(int driverIndex, std::pair<int, int> target) {
+    if (onDispatch) onDispatch(driverIndex, target); // Even a failed dispatch cancels the current ride
+    if (rides.size() < world.driverPos.size()) {
+        rides.resize(world.driverPos.size());
+    }
+    ActiveRide &ride = rides[driverIndex];
+    ride.target = target;
+    ride.refuelStops.clear();
+    ride.nextStop = 0;
+    bool reachable = componentLabels(world).connected(world.grid, world.driverPos[driverIndex], target);
+    if (!reachable || !planRoute(driverIndex)) {
+        ride.active = false;
+        if (onNoPath) onNoPath(driverIndex);
+        return false;
+    }
+
+    ride.active = true;
+    if (world.driverPos[driverIndex] == target) {
+        schedule(clock, SimEventType::DriverArrival, driverIndex);
+    } else if (!ride.movePending) {
+        schedule(clock + DRIVER_STEP_TIME, SimEventType::DriverMove, driverIndex);
+    }
+    return true;
+}
+
+// Refill a driver's tank; an en-route driver waits at its cell meanwhile
+void EventSimulator::scheduleRefuel(int driverIndex) {
+    if (rides.size() < world.driverPos.size()) {
+        rides.resize(world.driverPos.size());
+    }
+    rides[driverIndex].refuelling = true;
+    schedule(clock + REFUEL_TIME, SimEventType::DriverRefuel, driverIndex);
+}
+
+// Rides whose search depends on the cell are marked for repair. A cell on
+// the remaining route also forces a new route even when an equally cheap
+// detour leaves the costs unchanged.
+void EventSimulator::notifyCellChanged(std::pair<int, int> cell) {
+    for (ActiveRide &ride : rides) {
+        if (!ride.active) {
+            continue;
+        }
+        bool touched;
+        if (ride.planner) {
+            touched = ride.planner->cellChanged(cell);
+        } else {
+            // Off the route, only a cell that is passable now can matter:
+            // it may have opened or got cheaper
+            touched = world.grid.inBounds(cell.first, cell.second) &&
+                      world.grid.isPassable(cell.first, cell.second);
+        }
+        if (touched || ride.path.containsFrom(ride.position, cell)) {
+            ride.replanNeeded = true;
+        }
+    }
+}
+
+// Pass the cells updateGrid changed since the last check to notifyCellChanged.
+// Stations are left out, they do not change what a cell costs to cross.
+void EventSimulator::syncLayout() {
+    if (seenLayoutVersion == world.layoutVersion) {
+        return;
+    }
+    seenLayoutVersion = world.layoutVersion;
+    const std::vector<std::pair<int, int>> *current[3] = {
+        &world.layout.obstacles, &world.layout.trafficSignals, &world.layout.congestionZones
+    };
+    for (int layer = 0; layer < 3; layer++) {
+        layerCells = *current[layer];
+        std::sort(layerCells.begin(), layerCells.end());
+        changedCells.clear();
+        std::set_symmetric_difference(seenLayers[layer].begin(), seenLayers[layer].end(),
+                                      layerCells.begin(), layerCells.end(), std::back_inserter(changedCells));
+        for (std::pair<int, int> cell : changedCells) {
+            notifyCellChanged(cell);
+        }
+        seenLayers[layer].swap(layerCells);
+    }
+}
+
+// Advance a driver by one cell
+void EventSimulator::handleMove(int driverIndex) {
+    syncLayout();
+    ActiveRide &ride = rides[driverIndex];
+    ride.movePending = false;
+    if (!ride.active || ride.refuelling) {
+        return; // Resumed by handleRefuel or cancelled
+    }
+    // A finished leg (after a refuel stop) needs a route to the next one
+    bool routed = ride.path.atEnd(ride.position) ? planRoute(driverIndex)
+                                                 : !ride.replanNeeded || replanRoute(driverIndex);
+    if (routed && atRefuelStop(driverIndex)) {
+        ride.nextStop++;
+        scheduleRefuel(driverIndex); // handleRefuel resumes the ride
+        return;
+    }
+    if (!routed || world.driverFuel[driverIndex] <= 0) {
+        ride.active = false;
+        if (onNoPath) onNoPath(driverIndex);
+        return;
+    }
+
+    ride.path.advance(ride.position);
+    world.driverPos[driverIndex] = ride.position.cell;
+    world.driverFuel[driverIndex]--; // Decrease fuel as the driver moves
+
+    if (world.driverPos[driverIndex] == ride.target) {
+        schedule(clock, SimEventType::DriverArrival, driverIndex);
+        return;
+    }
+    if (atRefuelStop(driverIndex)) {
+        ride.nextStop++;
+        scheduleRefuel(driverIndex);
+        return;
+    }
+
+    // Path exhausted without reaching the target, plan again from here
+    if (ride.path.atEnd(ride.position) && !replanRoute(driverIndex)) {
+        ride.active = false;
+        if (onNoPath) onNoPath(driverIndex);
+        return;
+    }
+    schedule(clock + DRIVER_STEP_TIME, SimEventType::DriverMove, driverIndex);
+}
+
+// Finish the driver's current ride
+void EventSimulator::handleArrival(int driverIndex) {
+    rides[driverIndex].active = false;
+    rides[driverIndex].path.clear();
+    if (onArrival) onArrival(driverIndex);
+}
+
+// Fill the tank and resume the ride if one is in progress
+void EventSimulator::handleRefuel(int driverIndex) {
+    ActiveRide &ride = rides[driverIndex];
+    world.driverFuel[driverIndex] = FULL_TANK;
+    ride.refuelling = false;
+    if (ride.active && !ride.movePending) {
+        schedule(clock + DRIVER_STEP_TIME, SimEventType::DriverMove, driverIndex);
+    }
+}
+
+// Call the renderer for every sample point up to `time`
+void EventSimulator::renderUntil(double time, bool inclusive) {
+    if (!renderer) {
+        return;
+    }
+    while (nextRenderTime < time || (inclusive && nextRenderTime == time)) {
+        renderer(*this);
+        nextRenderTime += renderInterval;
+    }
+}
+
+void EventSimulator::setRenderer(std::function<void(const EventSimulator&)> callback, double interval) {
+    renderer = callback;
+    renderInterval = interval > 0.0 ? interval : DRIVER_STEP_TIME;
+    nextRenderTime = clock + renderInterval;
+}
+
+void EventSimulator::setArrivalCallback(std::function<void(int)> callback) {
+    onArrival = callback;
+}
+
+void EventSimulator::setNoPathCallback(std::function<void(int)> callback) {
+    onNoPath = callback;
+}
+
+void EventSimulator::setEventCallback(std::function<void(const SimEvent&)> callback) {
+    onEvent = callback;
+}
+
+void EventSimulator::setDispatchCallback(std::function<void(int, std::pair<int, int>)> callback) {
+    onDispatch = callback;
+}
+
+// Main event loop
+long long EventSimulator::run(double untilTime) {
+    long long processed = 0;
+    while (!events.empty()) {
+        SimEvent event = events.top();
+        if (untilTime >= 0.0 && event.time > untilTime) {
+            break;
+        }
+        // Samples before this event see the state after all earlier events
+        renderUntil(event.time, false);
+        events.pop();
+        clock = event.time;
+        processed++;
+        processedEvents++; // Callbacks of this event already count it
+
+        switch (event.type) {
+        case SimEventType::DriverMove:
+            handleMove(event.driverIndex);
+            break;
+        case SimEventType::DriverArrival:
+            handleArrival(event.driverIndex);
+            break;
+        case SimEventType::DriverRefuel:
+            handleRefuel(event.driverIndex);
+            break;
+        }
+        if (onEvent) onEvent(event);
+    }
+
+    if (untilTime >= 0.0 && clock < untilTime) {
+        clock = untilTime;
+    }
+    renderUntil(clock, true);
+    return processed;
+}
+
+double EventSimulator::now() const {
+    return clock;
+}
+
+bool EventSimulator::isIdle() const {
+    return events.empty();
+}
+
+bool EventSimulator::isEnRoute(int driverIndex) const {
+    return driverIndex < static_cast<int>(rides.size()) && rides[driverIndex].active;
+}
+
+long long EventSimulator::eventsProcessed() const {
+    return processedEvents;
+}
@@ -0,0 +1,143 @@
+#ifndef EVENT_SIMULATION_H
+#define EVENT_SIMULATION_H
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include "DStarLite.h"
+#include "CompactPath.h"
+#include "FuelRouter.h"
+
+struct SimulationWorld;
+
+// Virtual time (in simulated seconds) a driver needs to cross one grid cell
+const double DRIVER_STEP_TIME = 1.0;
+// Virtual time a driver spends at a fuel station
+const double REFUEL_TIME = 5.0;
+// Fuel level a driver has after refuelling
+const int FULL_TANK = 100;
+
+// Kinds of events the simulator can process
+enum class SimEventType {
+    DriverMove,    // Driver advances one cell along its route
+    DriverArrival, // Driver reached the target of its current ride
+    DriverRefuel   // Driver finished refuelling
+};
+
+// Event scheduled on the virtual clock
+struct SimEvent {
+    double time;       // Virtual time at which the event fires
+    long long seq;     // Insertion order, keeps same-time events FIFO
+    SimEventType type;
+    int driverIndex;
+};
+
+// Comparator for Min-Heap (Priority Queue) based on event time
+struct CompareEvent {
+    bool operator()(const SimEvent& a, const SimEvent& b) const;
+};
+
+// Route a driver is currently following
+struct ActiveRide {
+    bool active = false;
+    std::pair<int, int> target;
+    std::vector<std::pair<int, int>> refuelStops; // Stations on the way, see FuelRouter
+    size_t nextStop = 0;      // First stop not reached yet; the path leads there
+    CompactPath path;         // Run-length direction codes, see CompactPath
+    PathCursor position = PathCursor(); // Where on the path the driver is
+    bool movePending = false; // A DriverMove event is queued for this driver
+    bool refuelling = false;  // Driver is stopped until its DriverRefuel event
+    std::unique_ptr<DStarLite> planner; // Repair search for the current leg, built on the first repair
+    bool replanNeeded = false; // The map changed under the route
+};
+
+// Discrete-event simulator for driver movement.
+// Drivers are moved on a virtual clock instead of wall-clock sleeps, so any
+// number of drivers can be simulated and a run takes only as long as the
+// events take to process. Moves the drivers of one SimulationWorld.
+// Routes are planned with the world's path engine (findShortestPath). When
+// updateGrid changes obstacles, signals or zones mid-run, the changed cells
+// are passed to notifyCellChanged before the next move (a grid edited
+// directly must be reported by the caller). The affected rides repair their
+// routes at their next move; the first repair of a leg starts an incremental D* Lite search that
+// later repairs reuse, so rides on a static map never pay for one. Repairs
+// use the traversal costs when the weighted engine is selected and unit
+// costs otherwise.
+// A move burns one unit of fuel. When a driver's tank does not cover the
+// route, the ride is planned through fuel stations (findFuelRoute) and
+// driven one leg per stop, refuelling at each; a driver is never sent
+// further than its fuel reaches.
+class EventSimulator {
+private:
+    SimulationWorld &world;
+    std::priority_queue<SimEvent, std::vector<SimEvent>, CompareEvent> events;
+    std::vector<ActiveRide> rides; // Indexed by driver
+    std::vector<std::pair<int, int>> routeCells; // Planner output before encoding
+    FuelRoute fuelRoute;                         // Scratch for planRefuelStops
+    double clock;
+    long long nextSeq;
+    long long processedEvents;
+
+    // Obstacle, signal and zone cells (sorted) as of the world's layout
+    // version the rides last saw; see syncLayout()
+    uint64_t seenLayoutVersion;
+    std::vector<std::pair<int, int>> seenLayers[3];
+    std::vector<std::pair<int, int>> layerCells;   // Scratch for syncLayout
+    std::vector<std::pair<int, int>> changedCells;
+
+    std::function<void(const EventSimulator&)> renderer;
+    double renderInterval;
+    double nextRenderTime;
+
+    std::function<void(int)> onArrival;
+    std::function<void(int)> onNoPath;
+    std::function<void(const SimEvent&)> onEvent;
+    std::function<void(int, std::pair<int, int>)> onDispatch;
+
+    void schedule(double time, SimEventType type, int driverIndex);
+    bool storeRoute(ActiveRide &ride);
+    bool hasFuelFor(int driverIndex) const;
+    bool atRefuelStop(int driverIndex) const;
+    bool planRefuelStops(int driverIndex);
+    bool planRoute(int driverIndex);
+    bool replanRoute(int driverIndex);
+    void syncLayout();
+    void handleMove(int driverIndex);
+    void handleArrival(int driverIndex);
+    void handleRefuel(int driverIndex);
+    void renderUntil(double time, bool inclusive);
+
+public:
+    explicit EventSimulator(SimulationWorld &simulationWorld);
+    EventSimulator(); // Runs on mainWorld
+
+    // Send a driver towards a target cell, returns false if no path exists
+    // or the driver cannot get there on its fuel, even with refuel stops
+    bool dispatchRide(int driverIndex, std::pair<int, int> target);
+    // Refill a driver's tank after REFUEL_TIME, starting at the current time
+    void scheduleRefuel(int driverIndex);
+    // A cell was blocked, opened, or gained/lost a signal or congestion zone
+    void notifyCellChanged(std::pair<int, int> cell);
+
+    // Optional renderer, sampled every `interval` units of virtual time
+    void setRenderer(std::function<void(const EventSimulator&)> callback, double interval);
+    void setArrivalCallback(std::function<void(int)> callback);
+    void setNoPathCallback(std::function<void(int)> callback);
+    // Called after each processed event, and on each dispatchRide call with
+    // the driver and target (see TraceRecorder)
+    void setEventCallback(std::function<void(const SimEvent&)> callback);
+    void setDispatchCallback(std::function<void(int, std::pair<int, int>)> callback);
+
+    // Process events until the queue is empty or the clock passes `untilTime`
+    long long run(double untilTime = -1.0);
+
+    double now() const;
+    bool isIdle() const;
+    bool isEnRoute(int driverIndex) const;
+    long long eventsProcessed() const;
+};
+
+#endif // EVENT_SIMULATION_H
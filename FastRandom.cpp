@@ -0,0 +1,27 @@
+#include "FastRandom.h"
+
+FastRandom::FastRandom(uint64_t seed) {
+    reseed(seed);
+}
+
+// Expand the seed with splitmix64 so that nearby seeds give unrelated streams
+void FastRandom::reseed(uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state[i] = z ^ (z >> 31);
+    }
+}
+
+// Rejection on the low end of the range keeps the result unbiased
+uint64_t FastRandom::nextBelow(uint64_t bound) {
+    uint64_t threshold = (0 - bound) % bound;
+    while (true) {
+        uint64_t value = next();
+        if (value >= threshold) {
+            return value % bound;
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef FAST_RANDOM_H
+#define FAST_RANDOM_H
+
+#include <cstdint>
+
+// Small seedable random number generator (xoshiro256**).
+// Each instance has its own state, so separate simulations never share a
+// sequence the way they share the global rand(), and the same seed always
+// gives the same numbers on every platform.
+class FastRandom {
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    explicit FastRandom(uint64_t seed = 0);
+
+    void reseed(uint64_t seed);
+
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, bound), bound must be positive
+    uint64_t nextBelow(uint64_t bound);
+    // Uniform double in [0, 1)
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+#endif // FAST_RANDOM_H
@@ -0,0 +1,134 @@
+#include "FleetEngine.h"
+#include <chrono>
+
+// Drivers per chunk handed to a worker; large enough to amortize the atomic counter
+const size_t FLEET_CHUNK = 1024;
+
+FleetEngine::FleetEngine(const CityGrid &cityGrid, unsigned threadCount)
+    : grid(cityGrid), pool(threadCount), engine(PathEngine::AStar), ticks(0), tickSeconds(0.0), activeDrivers(0) {}
+
+int FleetEngine::addDriver(std::pair<int, int> pos, int fuel) {
+    state.cell.push_back(grid.indexOf(pos.first, pos.second));
+    state.target.push_back(-1);
+    state.fuel.push_back(fuel);
+    state.status.push_back(FleetStatus::Idle);
+    state.route.emplace_back();
+    state.routeCursor.push_back(PathCursor());
+    return static_cast<int>(state.size()) - 1;
+}
+
+void FleetEngine::assignTarget(int driver, std::pair<int, int> target) {
+    state.target[driver] = grid.indexOf(target.first, target.second);
+    state.status[driver] = FleetStatus::NeedsRoute;
+}
+
+void FleetEngine::importDrivers(const std::vector<std::pair<int, int>> &positions, const std::vector<int> &fuel) {
+    for (size_t i = 0; i < positions.size(); i++) {
+        addDriver(positions[i], i < fuel.size() ? fuel[i] : 0);
+    }
+}
+
+void FleetEngine::exportDrivers(std::vector<std::pair<int, int>> &positions, std::vector<int> &fuel) const {
+    positions.resize(state.size());
+    fuel.resize(state.size());
+    for (size_t i = 0; i < state.size(); i++) {
+        positions[i] = position(static_cast<int>(i));
+        fuel[i] = state.fuel[i];
+    }
+}
+
+void FleetEngine::setPathEngine(PathEngine pathEngine) {
+    engine = pathEngine;
+}
+
+// One tick for drivers [begin, end): plan, burn fuel, move, check arrival
+void FleetEngine::advanceRange(size_t begin, size_t end) {
+    thread_local PathfindingContext context;
+    thread_local std::vector<std::pair<int, int>> path;
+    int cols = grid.getCols();
+    size_t moving = 0;
+
+    for (size_t i = begin; i < end; i++) {
+        if (state.status[i] == FleetStatus::NeedsRoute) {
+            std::pair<int, int> from = {state.cell[i] / cols, state.cell[i] % cols};
+            std::pair<int, int> to = {state.target[i] / cols, state.target[i] % cols};
+            CompactPath &route = state.route[i];
+            if (!context.findPath(engine, grid, from, to, path) || !route.assign(path)) {
+                route.clear();
+                state.status[i] = FleetStatus::NoPath;
+                continue;
+            }
+            state.routeCursor[i] = route.begin();
+            state.status[i] = route.atEnd(state.routeCursor[i]) ? FleetStatus::Arrived : FleetStatus::EnRoute;
+        }
+        if (state.status[i] != FleetStatus::EnRoute) {
+            continue;
+        }
+
+        if (state.fuel[i] <= 0) {
+            state.status[i] = FleetStatus::OutOfFuel;
+            continue;
+        }
+        PathCursor &cursor = state.routeCursor[i];
+        state.route[i].advance(cursor);
+        state.cell[i] = cursor.cell.first * cols + cursor.cell.second;
+        state.fuel[i]--;
+
+        if (state.cell[i] == state.target[i]) {
+            state.status[i] = FleetStatus::Arrived;
+        } else {
+            moving++;
+        }
+    }
+    activeDrivers.fetch_add(moving, std::memory_order_relaxed);
+}
+
+void FleetEngine::tick() {
+    auto started = std::chrono::steady_clock::now();
+    activeDrivers.store(0);
+    pool.parallelFor(state.size(), FLEET_CHUNK, [this](size_t begin, size_t end) {
+        advanceRange(begin, end);
+    });
+    ticks++;
+    tickSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+long long FleetEngine::run(long long maxTicks) {
+    long long ran = 0;
+    while (ran < maxTicks) {
+        tick();
+        ran++;
+        if (activeDrivers.load() == 0) {
+            break;
+        }
+    }
+    return ran;
+}
+
+size_t FleetEngine::driverCount() const {
+    return state.size();
+}
+
+std::pair<int, int> FleetEngine::position(int driver) const {
+    return {state.cell[driver] / grid.getCols(), state.cell[driver] % grid.getCols()};
+}
+
+int FleetEngine::fuelLevel(int driver) const {
+    return state.fuel[driver];
+}
+
+FleetStatus FleetEngine::statusOf(int driver) const {
+    return state.status[driver];
+}
+
+size_t FleetEngine::movingDrivers() const {
+    return activeDrivers.load();
+}
+
+long long FleetEngine::ticksRun() const {
+    return ticks;
+}
+
+double FleetEngine::ticksPerSecond() const {
+    return tickSeconds > 0.0 ? ticks / tickSeconds : 0.0;
+}
@@ -0,0 +1,79 @@
+#ifndef FLEET_ENGINE_H
+#define FLEET_ENGINE_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "CityGrid.h"
+#include "Pathfinding.h"
+#include "CompactPath.h"
+#include "WorkerPool.h"
+
+// Lifecycle of a simulated driver
+enum class FleetStatus : uint8_t {
+    Idle,       // No target assigned
+    NeedsRoute, // Target assigned, route is planned on the next tick
+    EnRoute,    // Following its route
+    Arrived,    // Reached its target
+    NoPath,     // Target cannot be reached
+    OutOfFuel   // Stopped on the way with an empty tank
+};
+
+// Fleet state as a struct of arrays: element i of every array belongs to
+// driver i, so each tick phase streams through contiguous memory.
+// Positions and targets are flat cell indices (row * cols + col).
+struct FleetState {
+    std::vector<int> cell;
+    std::vector<int> target;
+    std::vector<int> fuel;
+    std::vector<FleetStatus> status;
+    std::vector<CompactPath> route;      // Planned cells from where the route was planned
+    std::vector<PathCursor> routeCursor; // Driver's place on `route`
+
+    size_t size() const { return cell.size(); }
+};
+
+// Tick-based movement engine that advances every driver each tick.
+// Drivers are split across a WorkerPool. Within one tick each driver plans
+// its route if needed, burns fuel, moves one cell and checks for arrival.
+// Drivers do not interact, so the chunks run without locks. Each thread
+// keeps its own PathfindingContext.
+class FleetEngine {
+private:
+    const CityGrid &grid;
+    FleetState state;
+    WorkerPool pool;
+    PathEngine engine;
+    long long ticks;
+    double tickSeconds;                 // Wall time spent inside tick()
+    std::atomic<size_t> activeDrivers;  // Drivers still moving after the last tick
+
+    void advanceRange(size_t begin, size_t end);
+
+public:
+    FleetEngine(const CityGrid &cityGrid, unsigned threadCount = 0);
+
+    int addDriver(std::pair<int, int> pos, int fuel);
+    void assignTarget(int driver, std::pair<int, int> target);
+    // Copy drivers in from, or back out to, the parallel global vectors
+    void importDrivers(const std::vector<std::pair<int, int>> &positions, const std::vector<int> &fuel);
+    void exportDrivers(std::vector<std::pair<int, int>> &positions, std::vector<int> &fuel) const;
+    void setPathEngine(PathEngine pathEngine);
+
+    void tick();
+    // Tick until no driver is moving or `maxTicks` have run, returns ticks run
+    long long run(long long maxTicks);
+
+    size_t driverCount() const;
+    std::pair<int, int> position(int driver) const;
+    int fuelLevel(int driver) const;
+    FleetStatus statusOf(int driver) const;
+    size_t movingDrivers() const;
+
+    long long ticksRun() const;
+    double ticksPerSecond() const; // Throughput over all ticks so far
+};
+
+#endif // FLEET_ENGINE_H
@@ -0,0 +1,140 @@
+#include "FuelRouter.h"
+#include <algorithm> // For max, fill and reverse
+#include <climits>   // For INT_MIN
+#include <cstdlib>   // For abs
+
+FuelRouter::FuelRouter() : rows(0), cols(0), generation(0), span(0), pending(0), expanded(0) {}
+
+// Size the per-cell state for the grid and start a new query
+void FuelRouter::prepare(int gridRows, int gridCols, int refuelCost) {
+    if (gridRows != rows || gridCols != cols) {
+        rows = gridRows;
+        cols = gridCols;
+        settled.assign(static_cast<size_t>(rows) * cols, CellState{0, 0});
+        generation = 0;
+    }
+    labels.clear();
+    span = static_cast<size_t>(std::max(2, refuelCost)) + 1;
+    if (buckets.size() < span) {
+        buckets.resize(span);
+    }
+    for (auto &bucket : buckets) {
+        bucket.clear();
+    }
+    pending = 0;
+    expanded = 0;
+
+    generation++;
+    if (generation == 0) { // Stamp wrapped around, old marks would look fresh
+        std::fill(settled.begin(), settled.end(), CellState{0, 0});
+        generation = 1;
+    }
+}
+
+int FuelRouter::bestFuelAt(int cell) const {
+    return settled[cell].stamp == generation ? settled[cell].fuel : INT_MIN;
+}
+
+void FuelRouter::pushLabel(int cell, int fuel, int cost, int parent, bool refuelled, int target) {
+    int h = std::abs(cell / cols - target / cols) + std::abs(cell % cols - target % cols);
+    labels.push_back({cell, fuel, cost, parent, refuelled});
+    buckets[(cost + h) % span].push_back(static_cast<int>(labels.size()) - 1);
+    pending++;
+}
+
+// Walk the parent labels back from the end; a refuel label adds a stop
+// instead of repeating its cell
+void FuelRouter::buildRoute(int label, FuelRoute &route) const {
+    route.cost = labels[label].cost;
+    for (int at = label; at >= 0; at = labels[at].parent) {
+        const Label &current = labels[at];
+        std::pair<int, int> cell = {current.cell / cols, current.cell % cols};
+        if (current.refuelled) {
+            route.refuelStops.push_back(cell);
+        } else {
+            route.path.push_back(cell);
+        }
+    }
+    std::reverse(route.path.begin(), route.path.end());
+    std::reverse(route.refuelStops.begin(), route.refuelStops.end());
+    route.steps = static_cast<int>(route.path.size()) - 1;
+}
+
+// Label-setting search over (cell, fuel); see the class comment
+bool FuelRouter::findRoute(const CityGrid &grid, std::pair<int, int> start, std::pair<int, int> end,
+                           int fuel, int tankCapacity, int refuelCost, FuelRoute &route,
+                           const FuelStationField *stations) {
+    route.path.clear();
+    route.refuelStops.clear();
+    route.steps = 0;
+    route.cost = 0;
+    refuelCost = std::max(0, refuelCost); // Keys must never go down
+    prepare(grid.getRows(), grid.getCols(), refuelCost);
+
+    int startIndex = start.first * cols + start.second;
+    int endIndex = end.first * cols + end.second;
+    pushLabel(startIndex, fuel, 0, -1, false, endIndex);
+    int key = std::abs(start.first - end.first) + std::abs(start.second - end.second);
+
+    for (; pending > 0; key++) {
+        std::vector<int> &bucket = buckets[key % span];
+        for (size_t k = 0; k < bucket.size(); k++) {
+            int index = bucket[k];
+            pending--;
+            Label label = labels[index];
+            int current = label.cell;
+            if (label.fuel <= bestFuelAt(current)) {
+                continue; // Dominated: an earlier label here was as cheap and had as much fuel
+            }
+            settled[current] = {generation, label.fuel};
+            expanded++;
+
+            if (current == endIndex) {
+                buildRoute(index, route);
+                return true;
+            }
+
+            int row = current / cols;
+            int col = current % cols;
+            if (label.fuel < tankCapacity &&
+                (stations ? stations->distanceToStation({row, col}) == 0 : grid.hasFuelStation({row, col}))) {
+                pushLabel(current, tankCapacity, label.cost + refuelCost, index, true, endIndex);
+            }
+            if (label.fuel <= 0) {
+                continue; // Empty tank, only a refuel gets this label moving
+            }
+
+            int neighbors[4] = {
+                col + 1 < cols ? current + 1 : -1,
+                col > 0 ? current - 1 : -1,
+                row + 1 < rows ? current + cols : -1,
+                row > 0 ? current - cols : -1
+            };
+            int nextFuel = label.fuel - 1;
+            for (int next : neighbors) {
+                if (next < 0 || !grid.isPassable(next) || nextFuel <= bestFuelAt(next)) {
+                    continue;
+                }
+                if (stations) {
+                    // Drop labels that can reach neither the end nor any station
+                    int toEnd = std::abs(next / cols - end.first) + std::abs(next % cols - end.second);
+                    int toStation = stations->distanceToStation({next / cols, next % cols});
+                    if (nextFuel < toEnd && (toStation < 0 || nextFuel < toStation)) {
+                        continue;
+                    }
+                }
+                pushLabel(next, nextFuel, label.cost + 1, index, false, endIndex);
+            }
+        }
+        bucket.clear();
+    }
+    return false; // Every route runs dry or the end is unreachable
+}
+
+int FuelRouter::lastExpandedCount() const {
+    return expanded;
+}
+
+size_t FuelRouter::lastLabelCount() const {
+    return labels.size();
+}
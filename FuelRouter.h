@@ -0,0 +1,75 @@
+#ifndef FUEL_ROUTER_H
+#define FUEL_ROUTER_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "CityGrid.h"
+#include "FuelStationField.h"
+
+// Route found by FuelRouter
+struct FuelRoute {
+    std::vector<std::pair<int, int>> path;        // Every cell, start and end included
+    std::vector<std::pair<int, int>> refuelStops; // Stations to fill up at, in driving order
+    int steps = 0;
+    int cost = 0; // Steps plus refuelCost per stop
+};
+
+// Shortest route for a driver with a limited tank (resource-constrained
+// shortest path). Every step burns one unit of fuel and a move needs fuel
+// left; at a fuel station the driver may fill the tank for a fixed cost.
+// The search is label-setting: a label is (cost, fuel) at a cell, taken off
+// a bucket queue in order of cost plus the Manhattan distance to the end, so
+// the labels of one cell come off in order of cost. A label is dominated if
+// an earlier label at its cell had at least as much fuel, so each cell only
+// keeps the highest fuel it has settled, and it is expanded again only by
+// labels that reach it with more fuel (after a refuel). Labels that can
+// neither reach the end nor any station on what is left in the tank are
+// dropped when a station field is given.
+class FuelRouter {
+private:
+    struct Label {
+        int cell;
+        int fuel;
+        int cost;
+        int parent;    // Index into labels, -1 at the start
+        bool refuelled; // Filled up at `cell` (parent is at the same cell)
+    };
+    struct CellState {
+        uint32_t stamp; // fuel is valid when stamp == generation
+        int fuel;       // Most fuel any settled label had at the cell
+    };
+
+    int rows;
+    int cols;
+    std::vector<CellState> settled;
+    uint32_t generation;
+    std::vector<Label> labels;
+    // Dial's circular buckets keyed by cost + heuristic. A push raises the
+    // key by 0 or 2 (a step) or by the refuel cost, so span buckets suffice.
+    std::vector<std::vector<int>> buckets;
+    size_t span;
+    size_t pending;
+    int expanded;
+
+    void prepare(int gridRows, int gridCols, int refuelCost);
+    int bestFuelAt(int cell) const;
+    void pushLabel(int cell, int fuel, int cost, int parent, bool refuelled, int target);
+    void buildRoute(int label, FuelRoute &route) const;
+
+public:
+    FuelRouter();
+
+    // Cheapest route from `start` to `end` starting with `fuel` in the tank.
+    // A refuel fills the tank to `tankCapacity` and costs `refuelCost`.
+    // `stations` is optional and must be in sync with `grid`; it is used to
+    // prune labels. Returns false if every route runs dry.
+    bool findRoute(const CityGrid &grid, std::pair<int, int> start, std::pair<int, int> end,
+                   int fuel, int tankCapacity, int refuelCost, FuelRoute &route,
+                   const FuelStationField *stations = nullptr);
+
+    int lastExpandedCount() const; // Labels settled by the last query
+    size_t lastLabelCount() const; // Labels created by the last query
+};
+
+#endif // FUEL_ROUTER_H
@@ -0,0 +1,301 @@
+#include "FuelStationField.h"
+#include <algorithm> // For fill and max
+
+FuelStationField::FuelStationField() : rows(0), cols(0), built(false), markGeneration(0) {}
+
+void FuelStationField::setBlockedBit(int index, bool blocked) {
+    if (blocked) {
+        blockedBits[index >> 6] |= uint64_t(1) << (index & 63);
+    } else {
+        blockedBits[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    }
+}
+
+// Values are compared as (distance, owner) so ties go to the lowest station id
+bool FuelStationField::improves(int index, int newDistance, int newOwner) const {
+    return distance[index] < 0 || newDistance < distance[index] ||
+           (newDistance == distance[index] && newOwner < owner[index]);
+}
+
+void FuelStationField::push(int index, int newDistance, int newOwner) {
+    distance[index] = newDistance;
+    owner[index] = newOwner;
+    if (newDistance >= static_cast<int>(levels.size())) {
+        levels.resize(newDistance + 1);
+    }
+    levels[newDistance].push_back(index);
+}
+
+// Queue a cell with the value it already has
+void FuelStationField::queueExisting(int index) {
+    push(index, distance[index], owner[index]);
+}
+
+// Process the bucket queue in distance order. Every step costs 1, so a cell
+// popped at level d is final and only pushes neighbors at level d + 1.
+void FuelStationField::propagate() {
+    for (size_t level = 0; level < levels.size(); level++) {
+        for (size_t k = 0; k < levels[level].size(); k++) {
+            int current = levels[level][k];
+            if (distance[current] != static_cast<int>(level)) {
+                continue; // Improved after it was queued
+            }
+            int row = current / cols;
+            int col = current % cols;
+            int neighbors[4] = {
+                col + 1 < cols ? current + 1 : -1,
+                col > 0 ? current - 1 : -1,
+                row + 1 < rows ? current + cols : -1,
+                row > 0 ? current - cols : -1
+            };
+            for (int next : neighbors) {
+                if (next >= 0 && !isBlocked(next) && improves(next, level + 1, owner[current])) {
+                    push(next, level + 1, owner[current]);
+                }
+            }
+        }
+        levels[level].clear();
+    }
+}
+
+// Collect and clear every cell whose value may have come through `start`:
+// cells reached by steps that keep the owner and add exactly one to the distance
+void FuelStationField::clearDerivedRegion(int start) {
+    markGeneration++;
+    if (markGeneration == 0) {
+        std::fill(mark.begin(), mark.end(), 0);
+        markGeneration = 1;
+    }
+    region.clear();
+    region.push_back(start);
+    mark[start] = markGeneration;
+
+    for (size_t k = 0; k < region.size(); k++) {
+        int current = region[k];
+        if (distance[current] < 0) {
+            continue;
+        }
+        int row = current / cols;
+        int col = current % cols;
+        int neighbors[4] = {
+            col + 1 < cols ? current + 1 : -1,
+            col > 0 ? current - 1 : -1,
+            row + 1 < rows ? current + cols : -1,
+            row > 0 ? current - cols : -1
+        };
+        for (int next : neighbors) {
+            if (next >= 0 && mark[next] != markGeneration &&
+                owner[next] == owner[current] && distance[next] == distance[current] + 1) {
+                mark[next] = markGeneration;
+                region.push_back(next);
+            }
+        }
+    }
+
+    for (int index : region) {
+        distance[index] = -1;
+        owner[index] = -1;
+    }
+}
+
+// Refill the cleared region from the intact cells bordering it
+void FuelStationField::refillRegion() {
+    for (int current : region) {
+        int row = current / cols;
+        int col = current % cols;
+        int neighbors[4] = {
+            col + 1 < cols ? current + 1 : -1,
+            col > 0 ? current - 1 : -1,
+            row + 1 < rows ? current + cols : -1,
+            row > 0 ? current - cols : -1
+        };
+        for (int next : neighbors) {
+            if (next >= 0 && mark[next] != markGeneration && distance[next] >= 0) {
+                queueExisting(next); // Re-expand with its current value
+            }
+        }
+    }
+    for (int id = 0; id < static_cast<int>(stations.size()); id++) {
+        if (stations[id].first >= 0 && mark[stations[id].first * cols + stations[id].second] == markGeneration) {
+            seedStation(id);
+        }
+    }
+    propagate();
+}
+
+// Stations on obstacle cells cannot be driven into, so they are not seeded
+void FuelStationField::seedStation(int id) {
+    std::pair<int, int> pos = stations[id];
+    if (pos.first < 0) {
+        return;
+    }
+    int index = pos.first * cols + pos.second;
+    if (!isBlocked(index) && improves(index, 0, id)) {
+        push(index, 0, id);
+    }
+}
+
+void FuelStationField::updateCell(int index, bool blocked) {
+    setBlockedBit(index, blocked);
+    if (blocked) {
+        clearDerivedRegion(index);
+        refillRegion();
+        return;
+    }
+
+    // Newly opened: let its neighbors and any station on it flow in
+    int row = index / cols;
+    int col = index % cols;
+    int neighbors[4] = {
+        col + 1 < cols ? index + 1 : -1,
+        col > 0 ? index - 1 : -1,
+        row + 1 < rows ? index + cols : -1,
+        row > 0 ? index - cols : -1
+    };
+    for (int next : neighbors) {
+        if (next >= 0 && distance[next] >= 0) {
+            queueExisting(next);
+        }
+    }
+    for (int id = 0; id < static_cast<int>(stations.size()); id++) {
+        if (stations[id].first >= 0 && stations[id].first * cols + stations[id].second == index) {
+            seedStation(id);
+        }
+    }
+    propagate();
+}
+
+void FuelStationField::build(const CityGrid &grid, const std::vector<std::pair<int, int>> &stationCells) {
+    rows = grid.getRows();
+    cols = grid.getCols();
+    size_t cellCount = grid.cellCount();
+    blockedBits = grid.getBlockedBits();
+    stations = stationCells;
+    distance.assign(cellCount, -1);
+    owner.assign(cellCount, -1);
+    mark.assign(cellCount, 0);
+    markGeneration = 0;
+    levels.clear();
+
+    for (int id = 0; id < static_cast<int>(stations.size()); id++) {
+        seedStation(id);
+    }
+    propagate();
+    built = true;
+}
+
+void FuelStationField::sync(const CityGrid &grid, const std::vector<std::pair<int, int>> &stationCells) {
+    if (!built || grid.getRows() != rows || grid.getCols() != cols) {
+        build(grid, stationCells);
+        return;
+    }
+
+    // Find the obstacle cells that changed; many changes are cheaper as a rebuild
+    const std::vector<uint64_t> &currentBits = grid.getBlockedBits();
+    std::vector<int> changed;
+    size_t rebuildThreshold = grid.cellCount() / 16 + 1;
+    for (size_t word = 0; word < currentBits.size(); word++) {
+        uint64_t diff = currentBits[word] ^ blockedBits[word];
+        while (diff) {
+            int bit = __builtin_ctzll(diff);
+            diff &= diff - 1;
+            changed.push_back(static_cast<int>(word * 64 + bit));
+            if (changed.size() > rebuildThreshold) {
+                build(grid, stationCells);
+                return;
+            }
+        }
+    }
+    for (int index : changed) {
+        updateCell(index, (currentBits[index >> 6] >> (index & 63)) & 1);
+    }
+
+    size_t stationCount = std::max(stations.size(), stationCells.size());
+    for (size_t id = 0; id < stationCount; id++) {
+        std::pair<int, int> before = id < stations.size() ? stations[id] : std::make_pair(-1, -1);
+        std::pair<int, int> after = id < stationCells.size() ? stationCells[id] : std::make_pair(-1, -1);
+        if (before == after) {
+            continue;
+        }
+        if (before.first >= 0) {
+            removeStation(static_cast<int>(id));
+        }
+        if (after.first >= 0) {
+            addStation(static_cast<int>(id), after);
+        }
+    }
+    stations.resize(stationCells.size());
+}
+
+void FuelStationField::addStation(int id, std::pair<int, int> pos) {
+    if (id >= static_cast<int>(stations.size())) {
+        stations.resize(id + 1, {-1, -1});
+    }
+    stations[id] = pos;
+    seedStation(id);
+    propagate();
+}
+
+void FuelStationField::removeStation(int id) {
+    if (id >= static_cast<int>(stations.size()) || stations[id].first < 0) {
+        return;
+    }
+    int index = stations[id].first * cols + stations[id].second;
+    stations[id] = {-1, -1};
+    if (owner[index] == id) {
+        clearDerivedRegion(index);
+        refillRegion();
+    }
+}
+
+void FuelStationField::setObstacle(std::pair<int, int> cell, bool blocked) {
+    int index = cell.first * cols + cell.second;
+    if (isBlocked(index) != blocked) {
+        updateCell(index, blocked);
+    }
+}
+
+// A cell on an obstacle is scored through its best open neighbor,
+// since a driver standing there can still drive off it
+int FuelStationField::nearestStation(std::pair<int, int> cell) const {
+    int index = cell.first * cols + cell.second;
+    if (!isBlocked(index)) {
+        return owner[index];
+    }
+    int bestDistance = -1, bestOwner = -1;
+    int dx[] = {0, 0, 1, -1};
+    int dy[] = {1, -1, 0, 0};
+    for (int d = 0; d < 4; d++) {
+        int row = cell.first + dx[d], col = cell.second + dy[d];
+        if (row < 0 || row >= rows || col < 0 || col >= cols) {
+            continue;
+        }
+        int next = row * cols + col;
+        if (distance[next] >= 0 && (bestDistance < 0 || distance[next] < bestDistance ||
+                                    (distance[next] == bestDistance && owner[next] < bestOwner))) {
+            bestDistance = distance[next];
+            bestOwner = owner[next];
+        }
+    }
+    return bestOwner;
+}
+
+int FuelStationField::distanceToStation(std::pair<int, int> cell) const {
+    int index = cell.first * cols + cell.second;
+    if (!isBlocked(index)) {
+        return distance[index];
+    }
+    int best = -1;
+    int dx[] = {0, 0, 1, -1};
+    int dy[] = {1, -1, 0, 0};
+    for (int d = 0; d < 4; d++) {
+        int row = cell.first + dx[d], col = cell.second + dy[d];
+        if (row >= 0 && row < rows && col >= 0 && col < cols) {
+            int next = row * cols + col;
+            if (distance[next] >= 0 && (best < 0 || distance[next] + 1 < best)) {
+                best = distance[next] + 1;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,64 @@
+#ifndef FUEL_STATION_FIELD_H
+#define FUEL_STATION_FIELD_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "CityGrid.h"
+
+// Nearest-fuel-station lookup table (a grid Voronoi diagram by road distance).
+// A multi-source BFS from every station stores, for each cell, the closest
+// reachable station and the number of steps to it, so a lookup is O(1).
+// Ties go to the lowest station id. The field keeps its own copy of the
+// obstacle bits and is repaired in place when stations or obstacles change:
+//  - a new station or a newly opened cell only pushes distances down from there;
+//  - a removed station or a newly blocked cell clears the cells whose value was
+//    derived through it, then refills them from the untouched cells around them.
+class FuelStationField {
+private:
+    int rows;
+    int cols;
+    bool built;
+    std::vector<uint64_t> blockedBits;          // Obstacles the field was computed for
+    std::vector<std::pair<int, int>> stations;  // By id, {-1, -1} once removed
+    std::vector<int> distance;                  // Steps to the owner, -1 if unreachable
+    std::vector<int> owner;                     // Closest station id, -1 if unreachable
+
+    // Work space for repairs
+    std::vector<std::vector<int>> levels; // Bucket queue keyed by distance
+    std::vector<uint32_t> mark;           // Cleared-region stamps
+    uint32_t markGeneration;
+    std::vector<int> region;
+
+    bool isBlocked(int index) const { return (blockedBits[index >> 6] >> (index & 63)) & 1; }
+    void setBlockedBit(int index, bool blocked);
+    bool improves(int index, int newDistance, int newOwner) const;
+    void push(int index, int newDistance, int newOwner);
+    void queueExisting(int index);
+    void propagate();
+    void clearDerivedRegion(int start);
+    void refillRegion();
+    void seedStation(int id);
+    void updateCell(int index, bool blocked);
+
+public:
+    FuelStationField();
+
+    // Full multi-source BFS
+    void build(const CityGrid &grid, const std::vector<std::pair<int, int>> &stationCells);
+    // Bring the field in line with the grid and station list, repairing
+    // only what changed (falls back to build() for large changes)
+    void sync(const CityGrid &grid, const std::vector<std::pair<int, int>> &stationCells);
+
+    void addStation(int id, std::pair<int, int> pos);
+    void removeStation(int id);
+    void setObstacle(std::pair<int, int> cell, bool blocked);
+
+    // Closest station id from `cell`, -1 if none is reachable
+    int nearestStation(std::pair<int, int> cell) const;
+    // Road distance to that station, -1 if none is reachable
+    int distanceToStation(std::pair<int, int> cell) const;
+    bool isBuilt() const { return built; }
+};
+
+#endif // FUEL_STATION_FIELD_H
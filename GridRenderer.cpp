@@ -0,0 +1,102 @@
+#include "GridRenderer.h"
+
+GridRenderer::GridRenderer()
+    : rows(0), cols(0), hasFrame(false), changedCells(0), cursorLine(1), cursorColumn(1) {}
+
+void GridRenderer::invalidate() {
+    hasFrame = false;
+}
+
+// Append an ANSI cursor move unless the cursor is already there
+void GridRenderer::moveCursor(int line, int column) {
+    if (line == cursorLine && column == cursorColumn) {
+        return;
+    }
+    buffer += "\033[";
+    buffer += std::to_string(line);
+    buffer += ';';
+    buffer += std::to_string(column);
+    buffer += 'H';
+    cursorLine = line;
+    cursorColumn = column;
+}
+
+// Clear the screen and draw the bordered grid, same layout as printGrid
+void GridRenderer::buildFullFrame(const CityGrid &grid) {
+    rows = grid.getRows();
+    cols = grid.getCols();
+    lastFrame.resize(static_cast<size_t>(rows) * cols);
+
+    std::string border = "+" + std::string(cols * 2, '-') + "+\n";
+    buffer += "\033[2J\033[1;1H";
+    buffer += border;
+    for (int i = 0; i < rows; i++) {
+        buffer += '|';
+        for (int j = 0; j < cols; j++) {
+            char cell = grid.cellAt(i, j);
+            lastFrame[static_cast<size_t>(i) * cols + j] = cell;
+            buffer += cell;
+            buffer += ' ';
+        }
+        buffer += "|\n";
+    }
+    buffer += border;
+    changedCells = lastFrame.size();
+    hasFrame = true;
+}
+
+// Redraw only the cells that differ from the last frame.
+// Cell (i, j) sits on screen line i + 2, column 2 + 2 * j.
+void GridRenderer::buildDiffFrame(const CityGrid &grid) {
+    cursorLine = -1;
+    cursorColumn = -1;
+    changedCells = 0;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            char cell = grid.cellAt(i, j);
+            char &previous = lastFrame[static_cast<size_t>(i) * cols + j];
+            if (cell == previous) {
+                continue;
+            }
+            int line = i + 2;
+            int column = 2 + 2 * j;
+            if (line == cursorLine && column == cursorColumn + 1) {
+                buffer += ' '; // Stepping over the separator is shorter than a cursor move
+                cursorColumn++;
+            }
+            moveCursor(line, column);
+            buffer += cell;
+            cursorColumn++;
+            previous = cell;
+            changedCells++;
+        }
+    }
+    // Leave the cursor below the grid and clear any text printed after the last frame
+    cursorLine = -1;
+    moveCursor(rows + 3, 1);
+    buffer += "\033[J";
+}
+
+const std::string &GridRenderer::buildFrame(const CityGrid &grid) {
+    buffer.clear();
+    if (!hasFrame || grid.getRows() != rows || grid.getCols() != cols) {
+        buildFullFrame(grid);
+    } else {
+        buildDiffFrame(grid);
+    }
+    return buffer;
+}
+
+void GridRenderer::render(const CityGrid &grid, std::ostream &out) {
+    const std::string &frame = buildFrame(grid);
+    out.write(frame.data(), frame.size());
+    out.flush();
+}
+
+size_t GridRenderer::lastChangedCells() const {
+    return changedCells;
+}
+
+size_t GridRenderer::lastFrameBytes() const {
+    return buffer.size();
+}
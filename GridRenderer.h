@@ -0,0 +1,46 @@
+#ifndef GRID_RENDERER_H
+#define GRID_RENDERER_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include "CityGrid.h"
+
+// Console renderer for the city grid that only redraws what changed.
+// It remembers the last frame it drew. The first frame is a full redraw
+// with the same layout printGrid always used. Later frames emit ANSI cursor
+// moves for changed cells only. Every frame is built in one buffer and
+// handed to the stream in a single write.
+class GridRenderer {
+private:
+    int rows;
+    int cols;
+    std::vector<char> lastFrame;
+    bool hasFrame;
+    std::string buffer;
+    size_t changedCells;
+
+    // Cursor position on screen (1-based) while building a diff frame
+    int cursorLine;
+    int cursorColumn;
+
+    void buildFullFrame(const CityGrid &grid);
+    void buildDiffFrame(const CityGrid &grid);
+    void moveCursor(int line, int column);
+
+public:
+    GridRenderer();
+
+    // Forget the last frame so the next one is drawn in full
+    void invalidate();
+    // Build the escape sequences for the current grid state
+    const std::string &buildFrame(const CityGrid &grid);
+    // Build a frame and write it to `out` in one call
+    void render(const CityGrid &grid, std::ostream &out);
+
+    size_t lastChangedCells() const; // Cells redrawn by the last frame
+    size_t lastFrameBytes() const;   // Bytes written by the last frame
+};
+
+#endif // GRID_RENDERER_H
@@ -0,0 +1,442 @@
+#include "HierarchicalGraph.h"
+#include <algorithm> // For min, max, fill, reverse and heap operations
+#include <cstdlib>   // For abs
+
+// Runs of open border cells at least this long get a transition at each end
+const int LONG_ENTRANCE = 6;
+
+HierarchicalGraph::HierarchicalGraph(int cellsPerCluster)
+    : rows(0), cols(0), clusterSize(std::max(2, cellsPerCluster)), clusterRows(0), clusterCols(0),
+      built(false), horizontalBorders(0), localGeneration(0), expanded(0), rebuiltClusters(0) {}
+
+int HierarchicalGraph::clusterOf(int cell) const {
+    return (cell / cols / clusterSize) * clusterCols + (cell % cols) / clusterSize;
+}
+
+void HierarchicalGraph::clusterBounds(int cluster, int &top, int &left, int &bottom, int &right) const {
+    top = (cluster / clusterCols) * clusterSize;
+    left = (cluster % clusterCols) * clusterSize;
+    bottom = std::min(rows, top + clusterSize) - 1;
+    right = std::min(cols, left + clusterSize) - 1;
+}
+
+// Find the entrances across one border and place their transitions
+void HierarchicalGraph::buildBorder(int border) {
+    std::vector<std::pair<int, int>> &transitions = borders[border];
+    transitions.clear();
+    bool horizontal = border < horizontalBorders;
+    int cluster = horizontal ? border : border - horizontalBorders;
+    int top, left, bottom, right;
+    clusterBounds(cluster, top, left, bottom, right);
+    if (horizontal ? cluster / clusterCols + 1 >= clusterRows : cluster % clusterCols + 1 >= clusterCols) {
+        return; // Edge of the map
+    }
+
+    // Walk along the border; (first, second) are the facing cells at position i
+    int length = horizontal ? right - left + 1 : bottom - top + 1;
+    auto facing = [&](int i) {
+        return horizontal ? std::make_pair(bottom * cols + left + i, (bottom + 1) * cols + left + i)
+                          : std::make_pair((top + i) * cols + right, (top + i) * cols + right + 1);
+    };
+    int runStart = -1;
+    for (int i = 0; i <= length; i++) {
+        bool open = i < length && isOpen(facing(i).first) && isOpen(facing(i).second);
+        if (open && runStart < 0) {
+            runStart = i;
+        } else if (!open && runStart >= 0) {
+            int runEnd = i - 1;
+            if (runEnd - runStart + 1 >= LONG_ENTRANCE) {
+                transitions.push_back(facing(runStart));
+                transitions.push_back(facing(runEnd));
+            } else {
+                transitions.push_back(facing((runStart + runEnd) / 2));
+            }
+            runStart = -1;
+        }
+    }
+}
+
+// Borders that touch a cluster: below, right, above and left of it
+void HierarchicalGraph::bordersOfCluster(int cluster, std::vector<int> &out) const {
+    out.clear();
+    out.push_back(cluster);
+    out.push_back(horizontalBorders + cluster);
+    if (cluster >= clusterCols) {
+        out.push_back(cluster - clusterCols);
+    }
+    if (cluster % clusterCols > 0) {
+        out.push_back(horizontalBorders + cluster - 1);
+    }
+}
+
+int HierarchicalGraph::nodeSlot(const Cluster &cluster, int cell) const {
+    for (size_t i = 0; i < cluster.nodes.size(); i++) {
+        if (cluster.nodes[i] == cell) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Collect a cluster's transition cells and cache the distances between them
+void HierarchicalGraph::buildCluster(int cluster) {
+    Cluster &data = clusters[cluster];
+    data.nodes.clear();
+    data.links.clear();
+
+    std::vector<int> touching;
+    bordersOfCluster(cluster, touching);
+    for (int border : touching) {
+        for (auto &transition : borders[border]) {
+            bool firstSide = clusterOf(transition.first) == cluster;
+            int own = firstSide ? transition.first : transition.second;
+            int other = firstSide ? transition.second : transition.first;
+            int slot = nodeSlot(data, own);
+            if (slot < 0) {
+                slot = static_cast<int>(data.nodes.size());
+                data.nodes.push_back(own);
+            }
+            data.links.push_back({slot, other});
+        }
+    }
+
+    size_t count = data.nodes.size();
+    data.costs.assign(count * count, -1);
+    int top, left, bottom, right;
+    clusterBounds(cluster, top, left, bottom, right);
+    for (size_t i = 0; i < count; i++) {
+        localSearch(cluster, data.nodes[i]);
+        for (size_t j = 0; j < count; j++) {
+            int cell = data.nodes[j];
+            int local = (cell / cols - top) * clusterSize + (cell % cols - left);
+            data.costs[i * count + j] = localStamp[local] == localGeneration ? localDistance[local] : -1;
+        }
+    }
+}
+
+// BFS from `source` that never leaves the cluster
+void HierarchicalGraph::localSearch(int cluster, int source) {
+    int top, left, bottom, right;
+    clusterBounds(cluster, top, left, bottom, right);
+    size_t area = static_cast<size_t>(clusterSize) * clusterSize;
+    if (localStamp.size() != area) {
+        localStamp.assign(area, 0);
+        localParent.assign(area, -1);
+        localDistance.assign(area, 0);
+        localQueue.assign(area, 0);
+        localGeneration = 0;
+    }
+    localGeneration++;
+    if (localGeneration == 0) {
+        std::fill(localStamp.begin(), localStamp.end(), 0);
+        localGeneration = 1;
+    }
+
+    int sourceLocal = (source / cols - top) * clusterSize + (source % cols - left);
+    localStamp[sourceLocal] = localGeneration;
+    localDistance[sourceLocal] = 0;
+    localParent[sourceLocal] = -1;
+    size_t head = 0, tail = 0;
+    localQueue[tail++] = sourceLocal;
+    while (head < tail) {
+        int current = localQueue[head++];
+        int row = current / clusterSize, col = current % clusterSize;
+        int neighbors[4][2] = {{row, col + 1}, {row, col - 1}, {row + 1, col}, {row - 1, col}};
+        for (auto &next : neighbors) {
+            if (next[0] < 0 || next[1] < 0 || top + next[0] > bottom || left + next[1] > right) {
+                continue;
+            }
+            int local = next[0] * clusterSize + next[1];
+            if (localStamp[local] != localGeneration && isOpen((top + next[0]) * cols + left + next[1])) {
+                localStamp[local] = localGeneration;
+                localDistance[local] = localDistance[current] + 1;
+                localParent[local] = current;
+                localQueue[tail++] = local;
+            }
+        }
+    }
+}
+
+// Append the in-cluster route from `from` to `to`, excluding `from`
+bool HierarchicalGraph::localPath(int cluster, int from, int to, std::vector<std::pair<int, int>> &path) {
+    int top, left, bottom, right;
+    clusterBounds(cluster, top, left, bottom, right);
+    localSearch(cluster, from);
+    int local = (to / cols - top) * clusterSize + (to % cols - left);
+    if (localStamp[local] != localGeneration) {
+        return false;
+    }
+    size_t first = path.size();
+    for (int at = local; localParent[at] >= 0; at = localParent[at]) {
+        path.push_back({top + at / clusterSize, left + at % clusterSize});
+    }
+    std::reverse(path.begin() + first, path.end());
+    return true;
+}
+
+void HierarchicalGraph::build(const CityGrid &grid) {
+    rows = grid.getRows();
+    cols = grid.getCols();
+    clusterRows = (rows + clusterSize - 1) / clusterSize;
+    clusterCols = (cols + clusterSize - 1) / clusterSize;
+    blockedBits = grid.getBlockedBits();
+    int clusterCount = clusterRows * clusterCols;
+    horizontalBorders = clusterCount;
+    clusters.assign(clusterCount, Cluster());
+    borders.assign(2 * clusterCount, std::vector<std::pair<int, int>>());
+    for (int border = 0; border < 2 * clusterCount; border++) {
+        buildBorder(border);
+    }
+    for (int cluster = 0; cluster < clusterCount; cluster++) {
+        buildCluster(cluster);
+    }
+    rebuiltClusters = clusterCount;
+    built = true;
+}
+
+void HierarchicalGraph::sync(const CityGrid &grid) {
+    rebuiltClusters = 0;
+    if (!built || grid.getRows() != rows || grid.getCols() != cols) {
+        build(grid);
+        return;
+    }
+
+    // Clusters holding a changed cell, and the borders it sits on
+    const std::vector<uint64_t> &currentBits = grid.getBlockedBits();
+    dirtyCluster.assign(clusters.size(), 0);
+    dirtyBorder.assign(borders.size(), 0);
+    size_t changed = 0, rebuildThreshold = grid.cellCount() / 16 + 1;
+    for (size_t word = 0; word < currentBits.size(); word++) {
+        uint64_t diff = currentBits[word] ^ blockedBits[word];
+        while (diff) {
+            int cell = static_cast<int>(word * 64 + __builtin_ctzll(diff));
+            diff &= diff - 1;
+            if (++changed > rebuildThreshold) {
+                build(grid);
+                return;
+            }
+            int cluster = clusterOf(cell);
+            int top, left, bottom, right;
+            clusterBounds(cluster, top, left, bottom, right);
+            int row = cell / cols, col = cell % cols;
+            dirtyCluster[cluster] = 1;
+            // Clusters on the last row or column have no border below or to the right
+            if (row == bottom && cluster / clusterCols + 1 < clusterRows) dirtyBorder[cluster] = 1;
+            if (col == right && cluster % clusterCols + 1 < clusterCols) dirtyBorder[horizontalBorders + cluster] = 1;
+            if (row == top && cluster >= clusterCols) dirtyBorder[cluster - clusterCols] = 1;
+            if (col == left && cluster % clusterCols > 0) dirtyBorder[horizontalBorders + cluster - 1] = 1;
+        }
+    }
+    if (changed == 0) {
+        return;
+    }
+    blockedBits = currentBits;
+
+    // A rebuilt border changes the nodes of the clusters on both sides
+    for (size_t border = 0; border < borders.size(); border++) {
+        if (!dirtyBorder[border]) {
+            continue;
+        }
+        buildBorder(static_cast<int>(border));
+        bool horizontal = static_cast<int>(border) < horizontalBorders;
+        int cluster = horizontal ? static_cast<int>(border) : static_cast<int>(border) - horizontalBorders;
+        int across = horizontal ? cluster + clusterCols : cluster + 1;
+        dirtyCluster[cluster] = 1;
+        if (across < static_cast<int>(dirtyCluster.size())) {
+            dirtyCluster[across] = 1;
+        }
+    }
+    for (size_t cluster = 0; cluster < clusters.size(); cluster++) {
+        if (dirtyCluster[cluster]) {
+            buildCluster(static_cast<int>(cluster));
+            rebuiltClusters++;
+        }
+    }
+}
+
+// Ordering for the abstract open list: lowest f first, ties go to the deeper node
+static bool openNodeLess(int fa, int ga, int fb, int gb) {
+    return fa > fb || (fa == fb && ga < gb);
+}
+
+bool HierarchicalGraph::findPath(const CityGrid &grid, std::pair<int, int> start, std::pair<int, int> end,
+                                 std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    expanded = 0;
+    if (!built) {
+        build(grid);
+    }
+    int startCell = start.first * cols + start.second;
+    int endCell = end.first * cols + end.second;
+    if (startCell == endCell) {
+        path.push_back(start);
+        return true;
+    }
+    if (!isOpen(endCell)) {
+        return false; // The end can never be entered
+    }
+
+    // The search leaves the start from seed cells: the start itself, or its
+    // open neighbors when the start is blocked (a blocked start may step
+    // straight into another cluster). Each seed links to its cluster's nodes.
+    std::vector<std::pair<int, int>> seeds;
+    if (isOpen(startCell)) {
+        seeds.push_back({startCell, 0});
+    } else {
+        int row = start.first, col = start.second;
+        int neighbors[4] = {
+            col + 1 < cols ? startCell + 1 : -1,
+            col > 0 ? startCell - 1 : -1,
+            row + 1 < rows ? startCell + cols : -1,
+            row > 0 ? startCell - cols : -1
+        };
+        for (int cell : neighbors) {
+            if (cell >= 0 && isOpen(cell)) {
+                seeds.push_back({cell, 1});
+            }
+        }
+    }
+
+    int endCluster = clusterOf(endCell);
+    int top, left, bottom, right;
+    std::unordered_map<int, std::vector<std::pair<int, int>>> seedEdges; // Seed -> (node, distance)
+    std::unordered_map<int, int> endEdges;
+    int directCost = -1, directSeed = -1;
+    for (auto &seed : seeds) {
+        int seedCluster = clusterOf(seed.first);
+        std::vector<std::pair<int, int>> &edges = seedEdges[seed.first];
+        clusterBounds(seedCluster, top, left, bottom, right);
+        localSearch(seedCluster, seed.first);
+        for (int node : clusters[seedCluster].nodes) {
+            int local = (node / cols - top) * clusterSize + (node % cols - left);
+            if (localStamp[local] == localGeneration) {
+                edges.push_back({node, localDistance[local]});
+            }
+        }
+        if (seedCluster == endCluster) {
+            int local = (endCell / cols - top) * clusterSize + (endCell % cols - left);
+            if (localStamp[local] == localGeneration &&
+                (directCost < 0 || seed.second + localDistance[local] < directCost)) {
+                directCost = seed.second + localDistance[local];
+                directSeed = seed.first;
+            }
+        }
+    }
+    clusterBounds(endCluster, top, left, bottom, right);
+    localSearch(endCluster, endCell);
+    for (int node : clusters[endCluster].nodes) {
+        int local = (node / cols - top) * clusterSize + (node % cols - left);
+        if (localStamp[local] == localGeneration) {
+            endEdges[node] = localDistance[local];
+        }
+    }
+
+    // A* over the abstract graph
+    auto heapLess = [](const OpenNode &a, const OpenNode &b) { return openNodeLess(a.f, a.g, b.f, b.g); };
+    searchState.clear();
+    openHeap.clear();
+    auto relax = [&](int cell, int g, int parent) {
+        auto it = searchState.find(cell);
+        if (it != searchState.end() && it->second.first <= g) {
+            return;
+        }
+        searchState[cell] = {g, parent};
+        int h = std::abs(cell / cols - end.first) + std::abs(cell % cols - end.second);
+        openHeap.push_back({g + h, g, cell});
+        std::push_heap(openHeap.begin(), openHeap.end(), heapLess);
+    };
+    if (!isOpen(startCell)) {
+        searchState[startCell] = {0, -1}; // Path root for the seeds
+    }
+    for (auto &seed : seeds) {
+        relax(seed.first, seed.second, seed.first == startCell ? -1 : startCell);
+    }
+    int abstractCost = -1;
+    while (!openHeap.empty()) {
+        std::pop_heap(openHeap.begin(), openHeap.end(), heapLess);
+        OpenNode entry = openHeap.back();
+        openHeap.pop_back();
+        if (entry.g > searchState[entry.cell].first) {
+            continue; // Stale entry
+        }
+        if (directCost >= 0 && entry.f >= directCost) {
+            break; // Staying inside the cluster is at least as short
+        }
+        expanded++;
+        if (entry.cell == endCell) {
+            abstractCost = entry.g;
+            break;
+        }
+
+        auto fromSeed = seedEdges.find(entry.cell);
+        if (fromSeed != seedEdges.end()) {
+            for (auto &edge : fromSeed->second) {
+                relax(edge.first, entry.g + edge.second, entry.cell);
+            }
+        }
+        const Cluster &cluster = clusters[clusterOf(entry.cell)];
+        int slot = nodeSlot(cluster, entry.cell);
+        if (slot >= 0) {
+            size_t count = cluster.nodes.size();
+            for (size_t j = 0; j < count; j++) {
+                int cost = cluster.costs[slot * count + j];
+                if (cost > 0) {
+                    relax(cluster.nodes[j], entry.g + cost, entry.cell);
+                }
+            }
+            for (auto &link : cluster.links) {
+                if (link.first == slot) {
+                    relax(link.second, entry.g + 1, entry.cell);
+                }
+            }
+        }
+        auto toEnd = endEdges.find(entry.cell);
+        if (toEnd != endEdges.end()) {
+            relax(endCell, entry.g + toEnd->second, entry.cell);
+        }
+    }
+
+    if (abstractCost < 0 && directCost < 0) {
+        return false; // No path found
+    }
+    path.push_back(start);
+    if (directCost >= 0 && (abstractCost < 0 || directCost <= abstractCost)) {
+        if (directSeed != startCell) {
+            path.push_back({directSeed / cols, directSeed % cols});
+        }
+        return localPath(clusterOf(directSeed), directSeed, endCell, path);
+    }
+
+    // Refine every abstract edge inside its cluster
+    std::vector<int> waypoints;
+    for (int at = endCell; at >= 0; at = searchState[at].second) {
+        waypoints.push_back(at);
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+    for (size_t i = 1; i < waypoints.size(); i++) {
+        int from = waypoints[i - 1], to = waypoints[i];
+        if (std::abs(from / cols - to / cols) + std::abs(from % cols - to % cols) == 1) {
+            path.push_back({to / cols, to % cols});
+        } else if (!localPath(clusterOf(from), from, to, path)) {
+            path.clear(); // Graph is out of date with the grid
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t HierarchicalGraph::nodeCount() const {
+    size_t count = 0;
+    for (const Cluster &cluster : clusters) {
+        count += cluster.nodes.size();
+    }
+    return count;
+}
+
+int HierarchicalGraph::lastExpandedCount() const {
+    return expanded;
+}
+
+int HierarchicalGraph::lastRebuiltClusters() const {
+    return rebuiltClusters;
+}
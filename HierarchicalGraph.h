@@ -0,0 +1,95 @@
+#ifndef HIERARCHICAL_GRAPH_H
+#define HIERARCHICAL_GRAPH_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <unordered_map>
+#include "CityGrid.h"
+
+// Abstract graph for hierarchical path-finding (HPA*).
+// The grid is cut into square clusters. Where two neighboring clusters
+// share a run of open border cells, an entrance (one transition in the
+// middle of the run, or one at each end of a long run) links them. Every
+// transition cell is a node. Inside a cluster, nodes are joined by edges
+// that hold their BFS distance within the cluster, computed once and
+// cached. A query links the start and end to the nodes of their clusters,
+// runs A* over the nodes and refines each abstract edge with a small
+// search inside one cluster, so route cost depends mostly on the route's
+// length in clusters rather than on the size of the map.
+// Paths are near-optimal: they can be a few steps longer than BFS, and
+// reachability is always the same.
+// sync() diffs the obstacle bits and rebuilds only the clusters around changed cells.
+class HierarchicalGraph {
+private:
+    struct Cluster {
+        std::vector<int> nodes;  // Transition cells
+        std::vector<int> costs;  // nodes.size()^2 in-cluster distances, -1 if disconnected
+        std::vector<std::pair<int, int>> links; // (node slot, cell across the border)
+    };
+    struct OpenNode {
+        int f;
+        int g;
+        int cell;
+    };
+
+    int rows;
+    int cols;
+    int clusterSize;
+    int clusterRows;
+    int clusterCols;
+    bool built;
+    std::vector<uint64_t> blockedBits; // Obstacles the graph was built for
+    std::vector<Cluster> clusters;
+    // Transitions per border as (cell on the first side, cell on the second side).
+    // Border b < horizontalBorders lies below cluster b; the rest lie right of a cluster.
+    std::vector<std::vector<std::pair<int, int>>> borders;
+    int horizontalBorders;
+
+    // Local search scratch (one cluster)
+    std::vector<uint32_t> localStamp;
+    std::vector<int> localParent;
+    std::vector<int> localQueue;
+    uint32_t localGeneration;
+    std::vector<int> localDistance;
+
+    // Abstract search scratch
+    std::unordered_map<int, std::pair<int, int>> searchState; // Cell -> (g, parent)
+    std::vector<OpenNode> openHeap;
+    int expanded;
+
+    // sync() scratch: clusters and borders to rebuild
+    std::vector<char> dirtyCluster;
+    std::vector<char> dirtyBorder;
+    int rebuiltClusters;
+
+    bool isOpen(int cell) const { return !((blockedBits[cell >> 6] >> (cell & 63)) & 1); }
+    int clusterOf(int cell) const;
+    void clusterBounds(int cluster, int &top, int &left, int &bottom, int &right) const;
+    void buildBorder(int border);
+    void buildCluster(int cluster);
+    void localSearch(int cluster, int source);
+    bool localPath(int cluster, int from, int to, std::vector<std::pair<int, int>> &path);
+    int nodeSlot(const Cluster &cluster, int cell) const;
+    void bordersOfCluster(int cluster, std::vector<int> &out) const;
+
+public:
+    explicit HierarchicalGraph(int cellsPerCluster = 16);
+
+    // Build the whole graph for the grid's current obstacles
+    void build(const CityGrid &grid);
+    // Rebuild only the clusters whose cells or borders changed
+    // (falls back to build() for large changes or a new grid size)
+    void sync(const CityGrid &grid);
+
+    // Near-optimal path with start and end included, false if unreachable
+    bool findPath(const CityGrid &grid, std::pair<int, int> start, std::pair<int, int> end,
+                  std::vector<std::pair<int, int>> &path);
+
+    bool isBuilt() const { return built; }
+    size_t nodeCount() const;
+    int lastExpandedCount() const;  // Abstract nodes expanded by the last query
+    int lastRebuiltClusters() const; // Clusters rebuilt by the last sync()
+};
+
+#endif // HIERARCHICAL_GRAPH_H
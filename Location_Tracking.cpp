@@ -1,24 +1,58 @@
 #include "Location_Tracking.h"
-#include <windows.h> // For Sleep function
-#include <cmath>     // For abs function
+#include "EventSimulation.h"
+#include "GridRenderer.h"
+#include "MapDisplay.h"
+#include "SpatialIndex.h"
+#include "FuelStationField.h"
+#include "FuelRouter.h"
+#include "ComponentLabels.h"
+#include "CooperativePlanner.h"
+#include "EntityPlacer.h"
+#include "ParallelBFS.h"
+#include "SimulationTrace.h"
+#ifdef _WIN32
+#include <windows.h> // For console handling
+#endif
+#include <cmath>     // For abs and ceil functions
 #include <cstdlib>   // For rand function
 #include <ctime>     // For seeding rand
 #include <algorithm> // For reverse function
 #include <iostream>
 #include <fstream>   // For file operations
 #include <sstream>   // For stringstream
+#include <thread>    // For sleep_for
+#include <chrono>    // For milliseconds
+#include <mutex>
+
+// The world the interactive program runs in; the familiar globals alias it
+SimulationWorld mainWorld;
+CityGrid &grid = mainWorld.grid;
+std::pair<int, int> &userPos = mainWorld.userPos;
+std::vector<std::pair<int, int>> &driverPos = mainWorld.driverPos;
+std::vector<std::string> &driverNames = mainWorld.driverNames;
+std::vector<std::string> &carModels = mainWorld.carModels;
+std::vector<int> &driverFuel = mainWorld.driverFuel;
+std::vector<std::pair<int, int>> &obstacles = mainWorld.obstacles;
+std::vector<std::pair<int, int>> &trafficSignals = mainWorld.trafficSignals;
+std::vector<std::pair<int, int>> &fuelStations = mainWorld.fuelStations;
+std::vector<std::pair<int, int>> &congestionZones = mainWorld.congestionZones;
+GridRenderer gridRenderer; // Remembers the frame on screen for printGrid
+std::string traceFile;     // Rides of moveDriverToUser are recorded here, empty for none
+
+SimulationWorld::SimulationWorld(int rows, int cols)
+    : grid(rows, cols), userPos(rows - 1, cols - 1), // Initial user position
+      pathEngine(PathEngine::BFS), cellOrder(CellOrder::RowMajor), stationFieldStale(true), componentsStale(true),
+      layoutVersion(0), placementSeed(0), entityPlacer(rows, cols, 0) {}
+
+// Function to set the map size at runtime
+void initGrid(SimulationWorld &world, int rows, int cols) {
+    world.grid.resize(rows, cols);
+    world.userPos = {rows - 1, cols - 1};
+}
 
-// Initialize grid and other variables
-char grid[GRID_SIZE][GRID_SIZE];
-std::pair<int, int> userPos = {GRID_SIZE - 1, GRID_SIZE - 1};   // Initial user position
-std::vector<std::pair<int, int>> driverPos;
-std::vector<std::string> driverNames;
-std::vector<std::string> carModels;
-std::vector<int> driverFuel;
-std::vector<std::pair<int, int>> obstacles;
-std::vector<std::pair<int, int>> trafficSignals;
-std::vector<std::pair<int, int>> fuelStations;
-std::vector<std::pair<int, int>> congestionZones;
+void initGrid(int rows, int cols) {
+    initGrid(mainWorld, rows, cols);
+}
 
 // Utility function to clear the console screen
 void clearConsole() {
@@ -41,55 +75,149 @@ void clearConsole() {
 #endif
 }
 
+// Function to start a new layout; the same seed always gives the same layout
+void setPlacementSeed(SimulationWorld &world, uint64_t seed) {
+    world.placementSeed = seed;
+    world.entityPlacer.reset(world.grid.getRows(), world.grid.getCols(), seed);
+}
+
+void setPlacementSeed(uint64_t seed) {
+    setPlacementSeed(mainWorld, seed);
+}
+
+void setTraceFile(const std::string &filename) {
+    traceFile = filename;
+}
+
 // Function to generate random non-overlapping positions
+// Cells are never shared with the user or with entities placed earlier.
+void generateNonOverlappingPositions(SimulationWorld &world, std::vector<std::pair<int, int>> &positions, int count) {
+    EntityPlacer &placer = world.entityPlacer;
+    if (placer.getRows() != world.grid.getRows() || placer.getCols() != world.grid.getCols()) {
+        placer.reset(world.grid.getRows(), world.grid.getCols(), world.placementSeed);
+    }
+    placer.reserve(world.userPos);
+    placer.place(positions, count);
+}
+
 void generateNonOverlappingPositions(std::vector<std::pair<int, int>> &positions, int count) {
-    while (positions.size() < count) {
-        std::pair<int, int> pos = {rand() % GRID_SIZE, rand() % GRID_SIZE};
-        if (std::find(positions.begin(), positions.end(), pos) == positions.end() && pos != userPos) {
-            positions.push_back(pos);
-        }
+    generateNonOverlappingPositions(mainWorld, positions, count);
+}
+
+#ifdef _WIN32
+// Let the Windows console interpret the ANSI sequences the renderer emits
+static bool enableAnsiConsole() {
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (!GetConsoleMode(hConsole, &mode)) {
+        return false;
     }
+    return SetConsoleMode(hConsole, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
 }
+#endif
 
 // Function to print the grid
+// Only cells that changed since the previous call are redrawn.
 void printGrid() {
-    clearConsole();
-    std::cout << "+" << std::string(GRID_SIZE * 2, '-') << "+" << std::endl;
-    for (int i = 0; i < GRID_SIZE; i++) {
-        std::cout << "|";
-        for (int j = 0; j < GRID_SIZE; j++) {
-            std::cout << grid[i][j] << " ";
-        }
-        std::cout << "|" << std::endl;
+#ifdef _WIN32
+    static bool ansiEnabled = enableAnsiConsole();
+    (void)ansiEnabled;
+#endif
+    gridRenderer.render(grid, std::cout);
+}
+
+// Function to make the next printGrid redraw the whole screen
+void resetGridDisplay() {
+    gridRenderer.invalidate();
+}
+
+// Function to fill a grid from entity positions
+// Obstacles go into the passability bits, everything else into the sparse layers.
+void populateGrid(CityGrid &target, std::pair<int, int> user,
+                  const std::vector<std::pair<int, int>> &drivers,
+                  const std::vector<std::pair<int, int>> &obstacleCells,
+                  const std::vector<std::pair<int, int>> &signalCells,
+                  const std::vector<std::pair<int, int>> &stationCells,
+                  const std::vector<std::pair<int, int>> &zoneCells) {
+    target.clear();
+
+    target.setUser(user); // User position
+    for (int i = 0; i < drivers.size(); i++) {
+        target.placeDriver(drivers[i], i); // Driver positions
+    }
+
+    for (auto obstacle : obstacleCells) {
+        target.setBlocked(obstacle.first, obstacle.second, true); // Obstacles
+    }
+    for (auto signal : signalCells) {
+        target.addTrafficSignal(signal); // Traffic signals
+    }
+    for (auto station : stationCells) {
+        target.addFuelStation(station); // Fuel stations
+    }
+    for (auto zone : zoneCells) {
+        target.addCongestionZone(zone); // Congestion zones
     }
-    std::cout << "+" << std::string(GRID_SIZE * 2, '-') << "+" << std::endl;
 }
 
 // Function to update the grid
-void updateGrid() {
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            grid[i][j] = '.'; // Empty space
-        }
+void updateGrid(SimulationWorld &world) {
+    populateGrid(world.grid, world.userPos, world.driverPos, world.obstacles,
+                 world.trafficSignals, world.fuelStations, world.congestionZones);
+    syncSpatialIndexes(world);
+    MapLayers &layout = world.layout;
+    if (layout.obstacles != world.obstacles || layout.trafficSignals != world.trafficSignals ||
+        layout.fuelStations != world.fuelStations || layout.congestionZones != world.congestionZones) {
+        layout.obstacles = world.obstacles;
+        layout.trafficSignals = world.trafficSignals;
+        layout.fuelStations = world.fuelStations;
+        layout.congestionZones = world.congestionZones;
+        world.layoutVersion++; // Simulators and the map display pick the change up from here
     }
+    // The per-cell tables are repaired on their next use, so worlds that never query them never build them
+    world.stationFieldStale = true;
+    world.componentsStale = true;
+}
 
-    grid[userPos.first][userPos.second] = 'U'; // User position
-    for (int i = 0; i < driverPos.size(); i++) {
-        grid[driverPos[i].first][driverPos[i].second] = static_cast<char>('A' + i); // Driver positions
-    }
+void updateGrid() {
+    updateGrid(mainWorld);
+}
 
-    for (auto obstacle : obstacles) {
-        grid[obstacle.first][obstacle.second] = '#'; // Obstacles
+const FuelStationField &stationField(const SimulationWorld &world) {
+    if (world.stationFieldStale) {
+        world.fuelStationField.sync(world.grid, world.fuelStations); // Repairs only what changed since the last sync
+        world.stationFieldStale = false;
     }
-    for (auto signal : trafficSignals) {
-        grid[signal.first][signal.second] = 'T'; // Traffic signals
+    return world.fuelStationField;
+}
+
+const ComponentLabels &componentLabels(const SimulationWorld &world) {
+    if (world.componentsStale) {
+        world.components.sync(world.grid);
+        world.componentsStale = false;
     }
-    for (auto station : fuelStations) {
-        grid[station.first][station.second] = 'F'; // Fuel stations
+    return world.components;
+}
+
+// Helper to move every entry of an index to its current position
+static void syncIndex(SpatialIndex &index, const CityGrid &map, const std::vector<std::pair<int, int>> &positions) {
+    if (index.getRows() != map.getRows() || index.getCols() != map.getCols()) {
+        index.reset(map.getRows(), map.getCols());
     }
-    for (auto zone : congestionZones) {
-        grid[zone.first][zone.second] = 'R'; // Congestion zones
+    for (size_t i = 0; i < positions.size(); i++) {
+        index.update(static_cast<int>(i), positions[i]); // Only entries that changed bucket move
     }
+    index.truncate(positions.size());
+}
+
+// Function to bring the spatial indexes in line with the entity vectors
+void syncSpatialIndexes(SimulationWorld &world) {
+    syncIndex(world.driverSpatialIndex, world.grid, world.driverPos);
+    syncIndex(world.stationSpatialIndex, world.grid, world.fuelStations);
+}
+
+void syncSpatialIndexes() {
+    syncSpatialIndexes(mainWorld);
 }
 
 // Function to calculate the Manhattan distance between two points
@@ -97,100 +225,338 @@ int calculateDistance(std::pair<int, int> a, std::pair<int, int> b) {
     return std::abs(a.first - b.first) + std::abs(a.second - b.second);
 }
 
-// Function to find the shortest path using BFS
-std::vector<std::pair<int, int>> findShortestPath(std::pair<int, int> start, std::pair<int, int> end) {
-    std::vector<std::vector<bool>> visited(GRID_SIZE, std::vector<bool>(GRID_SIZE, false));
-    std::map<std::pair<int, int>, std::pair<int, int>> parent;
-    std::queue<std::pair<int, int>> q;
+// Function to select the search engine used for routing
+void setPathEngine(PathEngine engine) {
+    mainWorld.pathEngine = engine;
+}
 
-    q.push(start);
-    visited[start.first][start.second] = true;
+PathEngine getPathEngine() {
+    return mainWorld.pathEngine;
+}
 
-    int dx[] = {0, 0, 1, -1};
-    int dy[] = {1, -1, 0, 0};
+// Function to select how BFS searches lay out their per-cell arrays
+void setCellOrder(CellOrder order) {
+    mainWorld.cellOrder = order;
+}
 
-    while (!q.empty()) {
-        std::pair<int, int> current = q.front();
-        q.pop();
+CellOrder getCellOrder() {
+    return mainWorld.cellOrder;
+}
 
-        if (current == end) {
-            std::vector<std::pair<int, int>> path;
-            while (current != start) {
-                path.push_back(current);
-                current = parent[current];
-            }
-            path.push_back(start);
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
+// Function to set how long signals and congestion zones take to cross
+void setTraversalCosts(const TraversalCosts &costs) {
+    mainWorld.traversalCosts = costs;
+}
 
-        for (int i = 0; i < 4; i++) {
-            int nx = current.first + dx[i];
-            int ny = current.second + dy[i];
-            if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE && !visited[nx][ny] && grid[nx][ny] != '#') {
-                visited[nx][ny] = true;
-                parent[{nx, ny}] = current;
-                q.push({nx, ny});
-            }
-        }
+TraversalCosts getTraversalCosts() {
+    return mainWorld.traversalCosts;
+}
+
+// Function to find the shortest path (BFS, bidirectional BFS, A*, Jump Point Search, least cost or HPA*)
+// Each thread keeps one search workspace, so repeated queries do not allocate.
+// Ends in different components are rejected before any search runs.
+bool findShortestPath(const SimulationWorld &world, std::pair<int, int> start, std::pair<int, int> end,
+                      std::vector<std::pair<int, int>> &path) {
+    thread_local PathfindingContext context;
+    if (!componentLabels(world).connected(world.grid, start, end)) {
+        path.clear();
+        return false;
+    }
+    context.setTraversalCosts(world.traversalCosts);
+    context.setCellOrder(world.cellOrder);
+    return context.findPath(world.pathEngine, world.grid, start, end, path);
+}
+
+bool findShortestPath(const SimulationWorld &world, std::pair<int, int> start, std::pair<int, int> end,
+                      CompactPath &path) {
+    thread_local std::vector<std::pair<int, int>> cells;
+    if (!findShortestPath(world, start, end, cells)) {
+        path.clear();
+        return false;
     }
-    return {}; // No path found
+    return path.assign(cells);
+}
+
+bool findShortestPath(std::pair<int, int> start, std::pair<int, int> end, std::vector<std::pair<int, int>> &path) {
+    return findShortestPath(mainWorld, start, end, path);
+}
+
+std::vector<std::pair<int, int>> findShortestPath(std::pair<int, int> start, std::pair<int, int> end) {
+    std::vector<std::pair<int, int>> path;
+    findShortestPath(start, end, path);
+    return path; // Empty if no path found
+}
+
+// Function to find the cheapest route that does not run out of fuel
+bool findFuelRoute(const SimulationWorld &world, std::pair<int, int> start, std::pair<int, int> end,
+                   int fuel, FuelRoute &route) {
+    thread_local FuelRouter router;
+    if (!componentLabels(world).connected(world.grid, start, end)) {
+        route.path.clear();
+        route.refuelStops.clear();
+        route.steps = 0;
+        route.cost = 0;
+        return false;
+    }
+    int refuelCost = static_cast<int>(std::ceil(REFUEL_TIME / DRIVER_STEP_TIME));
+    const FuelStationField &field = stationField(world);
+    const FuelStationField *stations = field.isBuilt() ? &field : nullptr;
+    return router.findRoute(world.grid, start, end, fuel, FULL_TANK, refuelCost, route, stations);
+}
+
+bool findFuelRoute(std::pair<int, int> start, std::pair<int, int> end, int fuel, FuelRoute &route) {
+    return findFuelRoute(mainWorld, start, end, fuel, route);
 }
 
 // Function to find the nearest fuel station
-std::pair<int, int> findNearestFuelStation(std::pair<int, int> driver) {
+// Uses the road-distance field; if no station can be reached by road it falls
+// back to the straight-line nearest one, as before.
+std::pair<int, int> findNearestFuelStation(const SimulationWorld &world, std::pair<int, int> driver) {
     std::pair<int, int> nearestStation;
-    int minDistance = INT_MAX;
-
-    for (auto station : fuelStations) {
-        int distance = calculateDistance(driver, station);
-        if (distance < minDistance) {
-            minDistance = distance;
-            nearestStation = station;
-        }
+    const FuelStationField &field = stationField(world);
+    int station = field.isBuilt() ? field.nearestStation(driver) : -1;
+    if (station < 0) {
+        station = world.stationSpatialIndex.nearest(driver);
+    }
+    if (station >= 0) {
+        nearestStation = world.fuelStations[station];
     }
     return nearestStation;
 }
 
+std::pair<int, int> findNearestFuelStation(std::pair<int, int> driver) {
+    return findNearestFuelStation(mainWorld, driver);
+}
+
+// Function to get the road distance to the nearest fuel station, -1 if none is reachable
+int distanceToNearestFuelStation(const SimulationWorld &world, std::pair<int, int> driver) {
+    const FuelStationField &field = stationField(world);
+    return field.isBuilt() ? field.distanceToStation(driver) : -1;
+}
+
+int distanceToNearestFuelStation(std::pair<int, int> driver) {
+    return distanceToNearestFuelStation(mainWorld, driver);
+}
+
+// Function to find the nearest driver by Manhattan distance
+int findNearestDriver(const SimulationWorld &world, std::pair<int, int> pos) {
+    return world.driverSpatialIndex.nearest(pos);
+}
+
+int findNearestDriver(std::pair<int, int> pos) {
+    return findNearestDriver(mainWorld, pos);
+}
+
+// Function to find the k nearest drivers by Manhattan distance
+std::vector<int> findNearestDrivers(const SimulationWorld &world, std::pair<int, int> pos, int k) {
+    return world.driverSpatialIndex.kNearest(pos, k);
+}
+
+std::vector<int> findNearestDrivers(std::pair<int, int> pos, int k) {
+    return findNearestDrivers(mainWorld, pos, k);
+}
+
 // Function to move the driver to the user
+// The ride runs on the event simulator. Once per step it publishes a snapshot
+// to the map display thread and paces playback; it never draws itself, so
+// the simulation never waits on the console. With a trace file set, the
+// ride is recorded there for replayTrace.
 void moveDriverToUser(int driverIndex) {
-    while (true) {
-        std::vector<std::pair<int, int>> path = findShortestPath(driverPos[driverIndex], userPos);
-        
-        // If no path is found, stop the simulation
-        if (path.empty()) {
-            std::cout << "\nNo valid path found for " << driverNames[driverIndex] << ". Simulation ends.\n";
-            break;
-        }
+    EventSimulator simulator;
+    SimulationTrace trace;
+    TraceRecorder recorder(mainWorld, simulator, trace);
+    if (!traceFile.empty()) {
+        recorder.attach();
+    }
+    bool arrived = false;
 
-        for (size_t i = 1; i < path.size(); i++) {
-            driverPos[driverIndex] = path[i];
-            driverFuel[driverIndex]--; // Decrease fuel as the driver moves
+    simulator.setArrivalCallback([&arrived](int) { arrived = true; });
+    simulator.setRenderer([driverIndex](const EventSimulator &) {
+        updateGrid();
+        mapDisplay.publish("Driver " + driverNames[driverIndex] + " is en route...");
+        std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Playback speed
+    }, DRIVER_STEP_TIME);
 
-            updateGrid();
-            printGrid();
-            std::cout << "\nDriver " << driverNames[driverIndex] << " is en route...\n";
-            Sleep(500); // Simulate movement delay
+    // If no path is found, stop the simulation
+    if (!simulator.dispatchRide(driverIndex, userPos)) {
+        std::cout << "\nNo valid path found for " << driverNames[driverIndex] << ". Simulation ends.\n";
+        return;
+    }
+
+    bool ownsDisplay = !mapDisplay.isRunning();
+    if (ownsDisplay) {
+        mapDisplay.start(std::chrono::milliseconds(100));
+    }
+    simulator.run();
+    if (ownsDisplay) {
+        mapDisplay.stop(); // Draws the final position
+    }
+    recorder.finish();
+    if (!traceFile.empty() && !saveTrace(trace, traceFile)) {
+        std::cout << "\nCould not write the ride trace to " << traceFile << ".\n";
+    }
 
-            // Check if the driver has reached the user
-            if (driverPos[driverIndex] == userPos) {
-                std::cout << "\nDriver " << driverNames[driverIndex] << " has arrived at your location!\n";
-                std::cout << "Simulation ends.\n";
-                return; // End the simulation once the driver reaches the user
+    if (arrived) {
+        std::cout << "\nDriver " << driverNames[driverIndex] << " has arrived at your location!\n";
+        std::cout << "Simulation ends.\n";
+    } else {
+        std::cout << "\nNo valid path found for " << driverNames[driverIndex] << ". Simulation ends.\n";
+    }
+}
+
+// Shared parallel BFS for large maps; its worker threads start on first use
+static ParallelBFS &parallelFieldSearch() {
+    static ParallelBFS search;
+    return search;
+}
+
+// Function to calculate the road distance from every driver to the target
+// A single BFS runs outward from the target instead of one search per driver.
+// With the weighted engine the field holds traversal costs instead of steps,
+// and maps of PARALLEL_FIELD_MIN_CELLS or more are flooded on all cores.
+// Drivers outside the target's component are skipped, and when none is
+// left no field is computed at all.
+std::vector<int> calculateDriverETAs(const SimulationWorld &world, std::pair<int, int> target) {
+    thread_local PathfindingContext context;
+    static std::mutex parallelMutex; // One large field at a time already uses every core
+    const CityGrid &grid = world.grid;
+    const std::vector<std::pair<int, int>> &driverPos = world.driverPos;
+    std::vector<char> reachable(driverPos.size(), 0);
+    bool anyReachable = false;
+    for (size_t i = 0; i < driverPos.size(); i++) {
+        reachable[i] = componentLabels(world).connected(grid, driverPos[i], target);
+        anyReachable = anyReachable || reachable[i];
+    }
+    std::vector<int> etas(driverPos.size(), -1);
+    if (!anyReachable) {
+        return etas;
+    }
+
+    bool weighted = world.pathEngine == PathEngine::Weighted;
+    bool parallel = !weighted && grid.cellCount() >= PARALLEL_FIELD_MIN_CELLS;
+    std::unique_lock<std::mutex> parallelLock(parallelMutex, std::defer_lock);
+    if (weighted) {
+        context.setTraversalCosts(world.traversalCosts);
+        context.computeCostField(grid, target);
+    } else if (parallel) {
+        parallelLock.lock();
+        parallelFieldSearch().computeDistanceField(grid, target);
+    } else {
+        context.setCellOrder(world.cellOrder);
+        context.computeDistanceField(grid, target);
+    }
+    auto fieldDistance = [&](std::pair<int, int> cell) {
+        return parallel ? parallelFieldSearch().distanceAt(cell) : context.fieldDistance(cell);
+    };
+
+    for (size_t i = 0; i < driverPos.size(); i++) {
+        std::pair<int, int> pos = driverPos[i];
+        if (!reachable[i]) {
+            continue;
+        }
+        if (grid.isPassable(pos.first, pos.second)) {
+            etas[i] = fieldDistance(pos);
+            continue;
+        }
+        // A driver standing on an obstacle cell can still drive off it
+        int dx[] = {0, 0, 1, -1};
+        int dy[] = {1, -1, 0, 0};
+        for (int d = 0; d < 4; d++) {
+            std::pair<int, int> next = {pos.first + dx[d], pos.second + dy[d]};
+            int distance = fieldDistance(next);
+            if (distance < 0) {
+                continue;
+            }
+            distance += weighted ? grid.traversalCost(grid.indexOf(next.first, next.second), context.getTraversalCosts()) : 1;
+            if (etas[i] < 0 || distance < etas[i]) {
+                etas[i] = distance;
             }
         }
     }
+    return etas;
+}
+
+// Function to route several drivers together so they never share a cell
+// or swap cells on the same tick (cooperative A* with a reservation table)
+bool findCooperativePaths(const SimulationWorld &world, const std::vector<int> &drivers,
+                          const std::vector<std::pair<int, int>> &targets,
+                          std::vector<std::vector<std::pair<int, int>>> &paths, int maxTicks) {
+    CooperativePlanner planner;
+    planner.reset(world.grid);
+    paths.assign(drivers.size(), std::vector<std::pair<int, int>>());
+    std::vector<bool> routed(drivers.size(), false);
+    for (size_t i = 0; i < drivers.size(); i++) {
+        std::pair<int, int> start = world.driverPos[drivers[i]];
+        routed[i] = componentLabels(world).connected(world.grid, start, targets[i]);
+        // Unreachable drivers still hold their cell so the others go around them
+        planner.addAgent(start, routed[i] ? targets[i] : start);
+        if (routed[i]) {
+            paths[i].push_back(start);
+        }
+    }
+
+    // A driver can pass its target before it is safe to stop there, so
+    // record every tick until all have arrived
+    bool allArrived = false;
+    for (int t = 0; t <= maxTicks; t++) {
+        allArrived = true;
+        for (size_t i = 0; i < drivers.size(); i++) {
+            if (routed[i] && !planner.atGoal(static_cast<int>(i))) {
+                allArrived = false;
+            }
+        }
+        if (allArrived || t == maxTicks) {
+            break;
+        }
+        planner.step();
+        for (size_t i = 0; i < drivers.size(); i++) {
+            if (routed[i]) {
+                paths[i].push_back(planner.positionOf(static_cast<int>(i)));
+            }
+        }
+    }
+    // Drivers stay at the end of their paths, so drop the trailing waits there
+    for (size_t i = 0; i < drivers.size(); i++) {
+        while (paths[i].size() > 1 && paths[i][paths[i].size() - 2] == paths[i].back()) {
+            paths[i].pop_back();
+        }
+    }
+    return allArrived;
+}
+
+std::vector<int> calculateDriverETAs(std::pair<int, int> target) {
+    return calculateDriverETAs(mainWorld, target);
+}
+
+// Function to pick the driver with the shortest road ETA, -1 if none can reach the target
+int selectNearestDriver(const SimulationWorld &world, std::pair<int, int> target) {
+    std::vector<int> etas = calculateDriverETAs(world, target);
+    int nearestDriverIndex = -1;
+    int minDistance = INT_MAX;
+    for (size_t i = 0; i < etas.size(); i++) {
+        if (etas[i] >= 0 && etas[i] < minDistance) {
+            minDistance = etas[i];
+            nearestDriverIndex = i;
+        }
+    }
+    return nearestDriverIndex;
 }
 
 // Function to display available drivers
 void displayDrivers() {
+    std::vector<int> etas = calculateDriverETAs(userPos);
     std::cout << "Available Drivers:\n";
     for (size_t i = 0; i < driverPos.size(); i++) {
         std::cout << i + 1 << ". " << driverNames[i]
              << " (Car: " << carModels[i]
              << ", Fuel: " << driverFuel[i]
              << ", Location: (" << driverPos[i].first << ", " << driverPos[i].second << ")"
-             << ", ETA: " << calculateDistance(driverPos[i], userPos) << ")\n";
+             << ", ETA: ";
+        if (etas[i] >= 0) {
+            std::cout << etas[i] << ")\n";
+        } else {
+            std::cout << "unreachable)\n";
+        }
     }
 }
 
@@ -221,9 +587,10 @@ void loadDriversFromFile(const std::string& filename) {
         driverNames.push_back(driverName);
         carModels.push_back(carModel);
         driverFuel.push_back(fuel);
-        driverPos.push_back({rand() % GRID_SIZE, rand() % GRID_SIZE}); // Random initial position
     }
     inFile.close();
+    // Random initial positions from the placement seed, on free cells
+    generateNonOverlappingPositions(driverPos, static_cast<int>(driverNames.size()));
 }
 
 // Function to load users from file
@@ -245,25 +612,20 @@ void startSimulation() {
     loadDriversFromFile("drivers.txt"); // Load drivers from file
     loadUsersFromFile("users.txt"); // Load users from file
     updateGrid();
+    resetGridDisplay();
     printGrid();
     printLegend();
     displayDrivers();
 
-    // Automatically select the nearest driver
-    int nearestDriverIndex = -1;
-    int minDistance = INT_MAX;
-    for (size_t i = 0; i < driverPos.size(); i++) {
-        int distance = calculateDistance(driverPos[i], userPos);
-        if (distance < minDistance) {
-            minDistance = distance;
-            nearestDriverIndex = i;
-        }
-    }
+    // Automatically select the nearest driver by road distance
+    int nearestDriverIndex = selectNearestDriver(mainWorld, userPos);
 
     if (nearestDriverIndex != -1) {
         std::cout << "Automatically selected nearest driver: " << driverNames[nearestDriverIndex] << ".\n";
         moveDriverToUser(nearestDriverIndex);
-    } else {
+    } else if (driverPos.empty()) {
         std::cout << "No drivers available.\n";
+    } else {
+        std::cout << "No driver can reach your location.\n";
     }
 }
@@ -7,31 +7,146 @@
 #include <map>
 #include <queue>
 #include <climits>
+#include <cstdint>
+#include "CityGrid.h"
+#include "Pathfinding.h"
+#include "SpatialIndex.h"
+#include "FuelStationField.h"
+#include "FuelRouter.h"
+#include "ComponentLabels.h"
+#include "CompactPath.h"
+#include "EntityPlacer.h"
 
 // Constants and Grid Dimensions
-const int GRID_SIZE = 20; // Increased grid size
-extern char grid[GRID_SIZE][GRID_SIZE];
-extern std::pair<int, int> userPos;
-extern std::vector<std::pair<int, int>> driverPos;
-extern std::vector<std::string> driverNames;
-extern std::vector<std::string> carModels;
-extern std::vector<int> driverFuel;
-extern std::vector<std::pair<int, int>> obstacles;
-extern std::vector<std::pair<int, int>> trafficSignals;
-extern std::vector<std::pair<int, int>> fuelStations;
-extern std::vector<std::pair<int, int>> congestionZones;
-
-// Function Declarations
+const int DEFAULT_GRID_SIZE = 20; // Size used until initGrid is called
+const size_t PARALLEL_FIELD_MIN_CELLS = 1 << 20; // Distance fields this large use ParallelBFS
+
+// Cells of the map layers that only change through updateGrid
+struct MapLayers {
+    std::vector<std::pair<int, int>> obstacles;
+    std::vector<std::pair<int, int>> trafficSignals;
+    std::vector<std::pair<int, int>> fuelStations;
+    std::vector<std::pair<int, int>> congestionZones;
+};
+
+// Everything one simulated city needs. Functions that take a world touch
+// nothing else, so independent worlds can be simulated on separate threads.
+struct SimulationWorld {
+    CityGrid grid;
+    std::pair<int, int> userPos;
+    std::vector<std::pair<int, int>> driverPos;
+    std::vector<std::string> driverNames;
+    std::vector<std::string> carModels;
+    std::vector<int> driverFuel;
+    std::vector<std::pair<int, int>> obstacles;
+    std::vector<std::pair<int, int>> trafficSignals;
+    std::vector<std::pair<int, int>> fuelStations;
+    std::vector<std::pair<int, int>> congestionZones;
+
+    PathEngine pathEngine;               // Search used by findShortestPath
+    CellOrder cellOrder;                 // Storage order for BFS routes and distance fields
+    TraversalCosts traversalCosts;       // Cell costs for PathEngine::Weighted
+    SpatialIndex driverSpatialIndex;     // Buckets over driverPos, kept in sync by updateGrid
+    SpatialIndex stationSpatialIndex;    // Buckets over fuelStations, kept in sync by updateGrid
+    // Derived per-cell tables, synced on first use after updateGrid (read
+    // them through stationField() and componentLabels())
+    mutable FuelStationField fuelStationField; // Nearest station by road for every cell
+    mutable ComponentLabels components;        // Connected regions of open cells
+    mutable bool stationFieldStale;
+    mutable bool componentsStale;
+    MapLayers layout;                    // Layers as the grid shows them, set by updateGrid
+    uint64_t layoutVersion;              // Bumped by updateGrid whenever `layout` changes
+    uint64_t placementSeed;              // Seed of the current layout
+    EntityPlacer entityPlacer;
+
+    SimulationWorld(int rows = DEFAULT_GRID_SIZE, int cols = DEFAULT_GRID_SIZE);
+};
+
+// World used by the interactive program; the globals below refer into it
+extern SimulationWorld mainWorld;
+extern CityGrid &grid;
+extern std::pair<int, int> &userPos;
+extern std::vector<std::pair<int, int>> &driverPos;
+extern std::vector<std::string> &driverNames;
+extern std::vector<std::string> &carModels;
+extern std::vector<int> &driverFuel;
+extern std::vector<std::pair<int, int>> &obstacles;
+extern std::vector<std::pair<int, int>> &trafficSignals;
+extern std::vector<std::pair<int, int>> &fuelStations;
+extern std::vector<std::pair<int, int>> &congestionZones;
+
+// Functions on a given world
+// Besides the grid itself (about 1 bit per cell of obstacle bits plus the
+// entity maps), a world builds two tables once something queries them:
+// the station field (about 12 bytes per cell, for fuel routing and nearest
+// station lookups) and the component labels (about 9 bytes per cell, for
+// every route and ETA query). At 16384 x 16384 that is 3.2 GB and 2.4 GB.
+void initGrid(SimulationWorld &world, int rows, int cols);
+void updateGrid(SimulationWorld &world);
+// The world's derived tables, brought in line with the grid if it changed since
+const FuelStationField &stationField(const SimulationWorld &world);
+const ComponentLabels &componentLabels(const SimulationWorld &world);
+void syncSpatialIndexes(SimulationWorld &world);
+void setPlacementSeed(SimulationWorld &world, uint64_t seed);
+void generateNonOverlappingPositions(SimulationWorld &world, std::vector<std::pair<int, int>> &positions, int count);
+bool findShortestPath(const SimulationWorld &world, std::pair<int, int> start, std::pair<int, int> end,
+                      std::vector<std::pair<int, int>> &path);
+bool findShortestPath(const SimulationWorld &world, std::pair<int, int> start, std::pair<int, int> end,
+                      CompactPath &path); // Same route, stored as direction codes
+// Cheapest route for a driver with `fuel` in the tank: the direct path if the
+// tank covers it, otherwise through the stations worth filling up at (FuelRouter).
+// A stop costs REFUEL_TIME in steps and fills the tank to FULL_TANK.
+bool findFuelRoute(const SimulationWorld &world, std::pair<int, int> start, std::pair<int, int> end,
+                   int fuel, FuelRoute &route);
+std::vector<int> calculateDriverETAs(const SimulationWorld &world, std::pair<int, int> target);
+// Collision-free routes for several drivers at once: paths[i] holds the cell of
+// drivers[i] at every tick (waits repeat a cell) until it stops for good, at
+// targets[i] unless time ran out; it stays on its last cell after that.
+// A driver that cannot reach its target gets an empty path and stays put.
+// Returns false if some reachable driver had not arrived after maxTicks.
+bool findCooperativePaths(const SimulationWorld &world, const std::vector<int> &drivers,
+                          const std::vector<std::pair<int, int>> &targets,
+                          std::vector<std::vector<std::pair<int, int>>> &paths, int maxTicks);
+int selectNearestDriver(const SimulationWorld &world, std::pair<int, int> target); // Shortest ETA, -1 if none can reach
+std::pair<int, int> findNearestFuelStation(const SimulationWorld &world, std::pair<int, int> driver);
+int distanceToNearestFuelStation(const SimulationWorld &world, std::pair<int, int> driver);
+int findNearestDriver(const SimulationWorld &world, std::pair<int, int> pos);
+std::vector<int> findNearestDrivers(const SimulationWorld &world, std::pair<int, int> pos, int k);
+
+// Function Declarations (these work on mainWorld)
+void initGrid(int rows, int cols); // Resize the map and put the user in the bottom-right corner
 void clearConsole();
 void printGrid();
+void resetGridDisplay(); // Next printGrid redraws the whole screen
 void updateGrid();
+void populateGrid(CityGrid &target, std::pair<int, int> user,
+                  const std::vector<std::pair<int, int>> &drivers,
+                  const std::vector<std::pair<int, int>> &obstacleCells,
+                  const std::vector<std::pair<int, int>> &signalCells,
+                  const std::vector<std::pair<int, int>> &stationCells,
+                  const std::vector<std::pair<int, int>> &zoneCells);
 int calculateDistance(std::pair<int, int> a, std::pair<int, int> b);
 std::vector<std::pair<int, int>> findShortestPath(std::pair<int, int> start, std::pair<int, int> end);
+bool findShortestPath(std::pair<int, int> start, std::pair<int, int> end, std::vector<std::pair<int, int>> &path); // Reuses path's storage
+bool findFuelRoute(std::pair<int, int> start, std::pair<int, int> end, int fuel, FuelRoute &route);
+void setPathEngine(PathEngine engine); // Select the search used by findShortestPath
+PathEngine getPathEngine();
+void setCellOrder(CellOrder order); // Z-order storage for BFS on maps larger than the cache
+CellOrder getCellOrder();
+void setTraversalCosts(const TraversalCosts &costs); // Cell costs used by PathEngine::Weighted
+TraversalCosts getTraversalCosts();
 void moveDriverToUser(int driverIndex);
+void setPlacementSeed(uint64_t seed); // Reset the placer; the same seed gives the same layout
+void setTraceFile(const std::string &filename); // Record each moveDriverToUser ride there (see SimulationTrace), "" for none
 void generateNonOverlappingPositions(std::vector<std::pair<int, int>> &positions, int count);
+std::vector<int> calculateDriverETAs(std::pair<int, int> target); // Road distance (or cost) per driver, -1 if unreachable
 void displayDrivers();
 void printLegend();
 void startSimulation();
 std::pair<int, int> findNearestFuelStation(std::pair<int, int> driver);
+int distanceToNearestFuelStation(std::pair<int, int> driver); // Road distance, -1 if unreachable
+int findNearestDriver(std::pair<int, int> pos);                      // Manhattan-closest driver, -1 if none
+std::vector<int> findNearestDrivers(std::pair<int, int> pos, int k); // k closest, nearest first
+void syncSpatialIndexes();                                           // Called by updateGrid
 
 #endif // SIMULATION_H
@@ -2,14 +2,17 @@
 #include "Traffic.h"
 #include "RideManager.h"
 #include "riderAndDriver.h"
+#include "MapDisplay.h"
+#include "SimulationTrace.h"
 #include <iostream>
 #include <thread>
-#include <cstdlib>   // For rand function
-#include <ctime>     // For seeding rand
+#include <cstdlib>   // For exit codes
+#include <ctime>     // For the placement seed
 #include <iomanip>   // For setw and setfill
 #include <vector>    // For std::vector in UserDriverHashTable
 #include <limits>    // For std::numeric_limits
 #include <string>    // For std::string
+#include <algorithm> // For find
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
@@ -156,16 +159,60 @@ void realTimeCommunication(const string& userName, const string& driverName) {
 }
 
 // Function to dynamically show the map/grid to the user and driver
+// The display thread draws published snapshots until mapDisplay.stop() is called.
 void showDynamicMap() {
-    while (true) {
-        updateGrid();
-        printGrid();
-        this_thread::sleep_for(chrono::seconds(1)); // Update every second
+    mapDisplay.publish();
+    mapDisplay.start(chrono::seconds(1)); // Update every second
+}
+
+// Function to replay a recorded ride without rendering
+// Usage: --replay <trace> [bfs|astar|jps|weighted|bitboard|hierarchical|bidirectional]
+int replayMode(const string& filename, const string& engineName) {
+    SimulationTrace trace;
+    if (!loadTrace(filename, trace)) {
+        cout << "Could not read trace " << filename << "." << endl;
+        return EXIT_FAILURE;
+    }
+    const string names[] = {"bfs", "astar", "jps", "weighted", "bitboard", "hierarchical", "bidirectional"};
+    PathEngine engine = trace.pathEngine;
+    if (!engineName.empty()) {
+        const string *found = find(begin(names), end(names), engineName);
+        if (found == end(names)) {
+            cout << "Unknown engine " << engineName << "." << endl;
+            return EXIT_FAILURE;
+        }
+        engine = static_cast<PathEngine>(found - begin(names));
     }
+
+    cout << "Trace: seed " << trace.seed << ", " << trace.rows << "x" << trace.cols << " grid, "
+         << trace.driverPos.size() << " drivers, " << trace.dispatches.size() << " rides, "
+         << trace.events.size() << " events, recorded with " << names[static_cast<int>(trace.pathEngine)] << endl;
+
+    SimulationWorld world;
+    ReplayResult forward = fastForwardTrace(trace, world);
+    cout << "Fast-forward: " << forward.events << " events to t=" << forward.endTime << ", "
+         << forward.moves << " cells driven, " << forward.arrivals << " arrivals, " << forward.refuels
+         << " refuels in " << forward.wallSeconds * 1000.0 << " ms"
+         << (forward.matches ? "" : ", trace is inconsistent") << endl;
+
+    ReplayResult replay = replayTrace(trace, world, engine);
+    cout << "Re-executed with " << names[static_cast<int>(engine)] << ": " << replay.events
+         << " events to t=" << replay.endTime << ", " << replay.moves << " cells driven, " << replay.arrivals
+         << " arrivals, " << replay.refuels << " refuels in " << replay.wallSeconds * 1000.0 << " ms, ";
+    if (replay.matches) {
+        cout << "identical to the trace" << endl;
+    } else {
+        cout << "differs from event " << replay.firstMismatch << endl;
+    }
+    return replay.matches || engine != trace.pathEngine ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc >= 3 && string(argv[1]) == "--replay") {
+        return replayMode(argv[2], argc >= 4 ? argv[3] : "");
+    }
+
     printCenteredBox("Welcome to Smart Ride");
     printCenteredBox("Smarter Rides");
 
@@ -358,11 +405,13 @@ int main()
                     cout << "Enter your destination: ";
                     cin >> end;
 
-                    srand(time(0));
-                    generateNonOverlappingPositions(obstacles, GRID_SIZE / 2);
-                    generateNonOverlappingPositions(trafficSignals, GRID_SIZE / 4);
-                    generateNonOverlappingPositions(fuelStations, GRID_SIZE / 5);
-                    generateNonOverlappingPositions(congestionZones, GRID_SIZE / 4);
+                    unsigned seed = time(0);
+                    setPlacementSeed(seed); // Recorded in the ride trace
+                    setTraceFile("ride.trace");
+                    generateNonOverlappingPositions(obstacles, grid.getRows() / 2);
+                    generateNonOverlappingPositions(trafficSignals, grid.getRows() / 4);
+                    generateNonOverlappingPositions(fuelStations, grid.getRows() / 5);
+                    generateNonOverlappingPositions(congestionZones, grid.getRows() / 4);
                     startSimulation();
 
                     // Find and display the shortest route
@@ -373,8 +422,7 @@ int main()
                     manager.requestRide(loggedInUserName);
 
                     // Start a thread to show the dynamic map
-                    thread mapThread(showDynamicMap);
-                    mapThread.detach();
+                    showDynamicMap();
                 }
                 break;
             case 3:
@@ -394,6 +442,7 @@ int main()
                 break;
             case 4:
                 std::cout << "Returning to main menu." << std::endl;
+                mapDisplay.stop();          // Stop the dynamic map, if running
                 userSessionActive = false;  // End the session
                 userLoggedIn = false;       // Set userLoggedIn to false to go back to main menu
                 break;
@@ -473,10 +522,10 @@ int main()
 
     if (userLoggedIn && driverLoggedIn) {
         realTimeCommunication(loggedInUserName, loggedInDriverName);
-        thread mapThread(showDynamicMap);
-        mapThread.detach();
+        showDynamicMap();
     }
 
+    mapDisplay.stop();
     system.saveToFile("users.txt", "drivers.txt");
     return 0;
 }
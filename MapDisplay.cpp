@@ -0,0 +1,120 @@
+#include "MapDisplay.h"
+#include "Location_Tracking.h"
+#include "GridRenderer.h"
+#include <iostream>
+
+MapDisplay mapDisplay;
+
+// SnapshotExchange definitions
+SnapshotExchange::SnapshotExchange() : middle(1), back(0), front(2) {}
+
+WorldSnapshot &SnapshotExchange::writeSlot() {
+    return slots[back];
+}
+
+void SnapshotExchange::publish() {
+    int previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+    back = previous & 3;
+}
+
+bool SnapshotExchange::acquireLatest() {
+    if (!(middle.load(std::memory_order_acquire) & FRESH)) {
+        return false;
+    }
+    int previous = middle.exchange(front, std::memory_order_acq_rel);
+    front = previous & 3;
+    return true;
+}
+
+const WorldSnapshot &SnapshotExchange::readSlot() const {
+    return slots[front];
+}
+
+// MapDisplay definitions
+MapDisplay::MapDisplay() : publishCount(0), running(false), frameInterval(1000) {}
+
+MapDisplay::~MapDisplay() {
+    stop();
+}
+
+// Copy the globals into the writer's slot. The slot's vectors keep their
+// capacity between publishes, so this does not allocate in steady state.
+// Each of the three slots remembers the layout version it holds, so a step
+// that only moved drivers copies the drivers, their fuel and the user.
+void MapDisplay::publish(const std::string &status) {
+    WorldSnapshot &snapshot = exchange.writeSlot();
+    snapshot.sequence = ++publishCount;
+    snapshot.rows = grid.getRows();
+    snapshot.cols = grid.getCols();
+    snapshot.userPos = userPos;
+    snapshot.driverPos.assign(driverPos.begin(), driverPos.end());
+    snapshot.driverFuel.assign(driverFuel.begin(), driverFuel.end());
+    if (snapshot.layoutVersion != mainWorld.layoutVersion) {
+        const MapLayers &layout = mainWorld.layout; // The layers as the grid shows them
+        snapshot.obstacles.assign(layout.obstacles.begin(), layout.obstacles.end());
+        snapshot.trafficSignals.assign(layout.trafficSignals.begin(), layout.trafficSignals.end());
+        snapshot.fuelStations.assign(layout.fuelStations.begin(), layout.fuelStations.end());
+        snapshot.congestionZones.assign(layout.congestionZones.begin(), layout.congestionZones.end());
+        snapshot.layoutVersion = mainWorld.layoutVersion;
+    }
+    snapshot.status = status;
+    exchange.publish();
+}
+
+// Draw the newest snapshot on every frame tick until stopped
+void MapDisplay::renderLoop() {
+    GridRenderer renderer;
+    CityGrid view(1, 1);
+
+    auto drawLatest = [&]() {
+        if (!exchange.acquireLatest()) {
+            return; // Nothing new since the last frame
+        }
+        const WorldSnapshot &snapshot = exchange.readSlot();
+        if (view.getRows() != snapshot.rows || view.getCols() != snapshot.cols) {
+            view.resize(snapshot.rows, snapshot.cols);
+        }
+        populateGrid(view, snapshot.userPos, snapshot.driverPos, snapshot.obstacles,
+                     snapshot.trafficSignals, snapshot.fuelStations, snapshot.congestionZones);
+        const std::string &frame = renderer.buildFrame(view);
+        std::cout.write(frame.data(), frame.size());
+        if (!snapshot.status.empty()) {
+            std::cout << "\n" << snapshot.status << "\n";
+        }
+        std::cout.flush();
+    };
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (running.load()) {
+        lock.unlock();
+        drawLatest();
+        lock.lock();
+        wakeSignal.wait_for(lock, frameInterval, [this]() { return !running.load(); });
+    }
+    lock.unlock();
+    drawLatest(); // Show the final state before exiting
+}
+
+void MapDisplay::start(std::chrono::milliseconds interval) {
+    if (running.load()) {
+        return;
+    }
+    frameInterval = interval;
+    running.store(true);
+    worker = std::thread(&MapDisplay::renderLoop, this);
+}
+
+void MapDisplay::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running.store(false);
+    }
+    wakeSignal.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool MapDisplay::isRunning() const {
+    return running.load();
+}
@@ -0,0 +1,86 @@
+#ifndef MAP_DISPLAY_H
+#define MAP_DISPLAY_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// Copy of the world state that the display thread draws from
+struct WorldSnapshot {
+    long long sequence = 0; // Increases with every publish
+    int rows = 0;
+    int cols = 0;
+    std::pair<int, int> userPos;
+    std::vector<std::pair<int, int>> driverPos;
+    std::vector<int> driverFuel;
+    // Layers that only change through updateGrid, copied when the world's
+    // layoutVersion moves past the one they were copied at
+    uint64_t layoutVersion = 0;
+    std::vector<std::pair<int, int>> obstacles;
+    std::vector<std::pair<int, int>> trafficSignals;
+    std::vector<std::pair<int, int>> fuelStations;
+    std::vector<std::pair<int, int>> congestionZones;
+    std::string status; // Line printed under the map
+};
+
+// Lock-free triple buffer for handing snapshots from one writer thread to
+// one reader thread. The writer fills its own slot and swaps it into the
+// shared middle slot with one atomic exchange. The reader swaps the middle
+// slot out the same way. Neither side waits for the other, and the reader
+// only ever sees complete snapshots.
+class SnapshotExchange {
+private:
+    static const int FRESH = 4; // Set on `middle` when it holds an unread snapshot
+    WorldSnapshot slots[3];
+    std::atomic<int> middle; // Slot index | FRESH
+    int back;                // Slot owned by the writer
+    int front;               // Slot owned by the reader
+
+public:
+    SnapshotExchange();
+
+    WorldSnapshot &writeSlot();        // Writer: slot to fill
+    void publish();                    // Writer: make the filled slot the latest
+    bool acquireLatest();              // Reader: take the latest slot if it is new
+    const WorldSnapshot &readSlot() const; // Reader: last acquired snapshot
+};
+
+// Background map view.
+// The simulation calls publish() after it changes the world. The display
+// thread wakes at a fixed frame rate and draws the newest snapshot, and it
+// never touches the live globals. stop() draws the last snapshot and then
+// joins the thread.
+class MapDisplay {
+private:
+    SnapshotExchange exchange;
+    long long publishCount;
+    std::thread worker;
+    std::atomic<bool> running;
+    std::mutex wakeMutex;
+    std::condition_variable wakeSignal;
+    std::chrono::milliseconds frameInterval;
+
+    void renderLoop();
+
+public:
+    MapDisplay();
+    ~MapDisplay();
+
+    // Copy the current global world state and hand it to the display thread.
+    // The static layers are copied only after updateGrid changed them.
+    void publish(const std::string &status = "");
+    void start(std::chrono::milliseconds interval);
+    void stop();
+    bool isRunning() const;
+};
+
+// Shared display used by the ride flow and the menus
+extern MapDisplay mapDisplay;
+
+#endif // MAP_DISPLAY_H
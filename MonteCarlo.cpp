@@ -0,0 +1,109 @@
+#include "MonteCarlo.h"
+#include "EventSimulation.h"
+#include "WorkerPool.h"
+#include "FastRandom.h"
+#include <algorithm> // For sort and find
+#include <cmath>     // For sqrt
+#include <chrono>
+
+// Function to simulate one seeded scenario
+double runScenario(const ScenarioConfig &config, uint64_t seed) {
+    SimulationWorld world(config.rows, config.cols);
+    world.pathEngine = config.engine;
+    setPlacementSeed(world, seed);
+    generateNonOverlappingPositions(world, world.obstacles, config.obstacles);
+    generateNonOverlappingPositions(world, world.trafficSignals, config.trafficSignals);
+    generateNonOverlappingPositions(world, world.fuelStations, config.fuelStations);
+    generateNonOverlappingPositions(world, world.congestionZones, config.congestionZones);
+    generateNonOverlappingPositions(world, world.driverPos, config.drivers);
+    world.driverFuel.assign(world.driverPos.size(), FULL_TANK);
+    updateGrid(world);
+
+    int driver = selectNearestDriver(world, world.userPos);
+    if (driver < 0) {
+        return -1.0;
+    }
+
+    EventSimulator simulator(world);
+    // Close one free cell per step; the simulator reads the change from updateGrid
+    FastRandom closureRandom(seed ^ 0x9E3779B97F4A7C15ULL);
+    int closuresLeft = config.roadClosures;
+    if (closuresLeft > 0) {
+        simulator.setRenderer([&world, &closureRandom, &closuresLeft](const EventSimulator &) {
+            if (closuresLeft == 0) {
+                return;
+            }
+            int row = static_cast<int>(closureRandom.nextBelow(world.grid.getRows()));
+            int col = static_cast<int>(closureRandom.nextBelow(world.grid.getCols()));
+            std::pair<int, int> cell = {row, col};
+            if (!world.grid.isPassable(row, col) || cell == world.userPos ||
+                std::find(world.driverPos.begin(), world.driverPos.end(), cell) != world.driverPos.end()) {
+                return; // Skipped this step, tried again at the next one
+            }
+            world.obstacles.push_back(cell);
+            updateGrid(world);
+            closuresLeft--;
+        }, DRIVER_STEP_TIME);
+    }
+    bool arrived = false;
+    simulator.setArrivalCallback([&arrived](int) { arrived = true; });
+    if (!simulator.dispatchRide(driver, world.userPos)) {
+        return -1.0;
+    }
+    simulator.run();
+    return arrived ? simulator.now() : -1.0;
+}
+
+// Value at quantile q of a sorted sample (nearest rank)
+static double quantile(const std::vector<double> &sorted, double q) {
+    size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Function to run a batch of scenarios in parallel and summarise the pickup times
+BatchStatistics runMonteCarloBatch(const ScenarioConfig &config, int scenarioCount, uint64_t baseSeed,
+                                   unsigned threadCount, std::vector<double> *pickupTimes) {
+    BatchStatistics stats;
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<double> results(scenarioCount > 0 ? scenarioCount : 0, -1.0);
+    WorkerPool pool(threadCount);
+    pool.parallelFor(results.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            results[i] = runScenario(config, baseSeed + i);
+        }
+    });
+
+    std::vector<double> served;
+    for (double time : results) {
+        if (time >= 0.0) {
+            served.push_back(time);
+        }
+    }
+    stats.scenarios = static_cast<int>(results.size());
+    stats.served = static_cast<int>(served.size());
+    stats.unserved = stats.scenarios - stats.served;
+
+    if (!served.empty()) {
+        std::sort(served.begin(), served.end());
+        double sum = 0.0, sumSquares = 0.0;
+        for (double time : served) {
+            sum += time;
+            sumSquares += time * time;
+        }
+        stats.meanPickupTime = sum / served.size();
+        double variance = sumSquares / served.size() - stats.meanPickupTime * stats.meanPickupTime;
+        stats.stdDevPickupTime = std::sqrt(std::max(0.0, variance));
+        stats.minPickupTime = served.front();
+        stats.medianPickupTime = quantile(served, 0.5);
+        stats.p90PickupTime = quantile(served, 0.9);
+        stats.p99PickupTime = quantile(served, 0.99);
+        stats.maxPickupTime = served.back();
+    }
+
+    if (pickupTimes) {
+        *pickupTimes = results;
+    }
+    stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
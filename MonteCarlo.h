@@ -0,0 +1,50 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include <vector>
+#include <cstdint>
+#include "Location_Tracking.h"
+
+// Layout of one randomly generated scenario
+struct ScenarioConfig {
+    int rows = DEFAULT_GRID_SIZE;
+    int cols = DEFAULT_GRID_SIZE;
+    int drivers = 5;
+    int obstacles = DEFAULT_GRID_SIZE / 2;
+    int trafficSignals = DEFAULT_GRID_SIZE / 4;
+    int fuelStations = DEFAULT_GRID_SIZE / 5;
+    int congestionZones = DEFAULT_GRID_SIZE / 4;
+    PathEngine engine = PathEngine::BFS;
+    int roadClosures = 0; // Obstacles added one per step while the ride runs
+};
+
+// Aggregated pickup times of a batch, in simulated seconds
+struct BatchStatistics {
+    int scenarios = 0;
+    int served = 0;   // Scenarios where a driver reached the user
+    int unserved = 0; // No driver could reach the user
+    double meanPickupTime = 0.0;
+    double stdDevPickupTime = 0.0;
+    double minPickupTime = 0.0;
+    double medianPickupTime = 0.0;
+    double p90PickupTime = 0.0;
+    double p99PickupTime = 0.0;
+    double maxPickupTime = 0.0;
+    double wallSeconds = 0.0; // Real time the batch took
+};
+
+// Build a world from `config` and `seed`, send the driver with the shortest
+// ETA to the user and return the simulated pickup time, -1 if no driver can
+// reach the user. With roadClosures set, random free cells are blocked
+// through updateGrid during the ride, and the driver replans around them.
+// The same config and seed always give the same result.
+double runScenario(const ScenarioConfig &config, uint64_t seed);
+
+// Run `scenarioCount` scenarios with seeds baseSeed, baseSeed + 1, ...
+// on a WorkerPool. Every scenario owns its world, so they run without
+// locks, and the statistics do not depend on the number of threads.
+// `pickupTimes` receives each scenario's result (-1 if unserved) in seed order.
+BatchStatistics runMonteCarloBatch(const ScenarioConfig &config, int scenarioCount, uint64_t baseSeed,
+                                   unsigned threadCount = 0, std::vector<double> *pickupTimes = nullptr);
+
+#endif // MONTE_CARLO_H
@@ -0,0 +1,221 @@
+#include "ParallelBFS.h"
+#include <algorithm> // For reverse
+
+// Frontier cells per top-down chunk and bitset words per bottom-up chunk
+const size_t TOP_DOWN_CHUNK = 1024;
+const size_t BOTTOM_UP_CHUNK = 256;
+// Beamer's switching thresholds: go bottom-up once the frontier exceeds
+// 1/ALPHA of the unvisited cells, return when it falls below 1/BETA of all cells
+const size_t SWITCH_ALPHA = 14;
+const size_t SWITCH_BETA = 24;
+
+ParallelBFS::ParallelBFS(unsigned threadCount)
+    : pool(threadCount), rows(0), cols(0), visitedWords(0), levels(0), bottomUpLevels(0) {}
+
+// Size the arrays for the grid and clear them
+void ParallelBFS::prepare(const CityGrid &grid) {
+    rows = grid.getRows();
+    cols = grid.getCols();
+    size_t cellCount = grid.cellCount();
+    size_t words = (cellCount + 63) / 64;
+    if (words != visitedWords) {
+        visited.reset(new std::atomic<uint64_t>[words]);
+        visitedWords = words;
+    }
+    pool.parallelFor(words, 4096, [this](size_t begin, size_t end) {
+        for (size_t word = begin; word < end; word++) {
+            visited[word].store(0, std::memory_order_relaxed);
+        }
+    });
+    distance.assign(cellCount, -1);
+    frontierBits.assign(words, 0);
+    frontier.clear();
+    levels = 0;
+    bottomUpLevels = 0;
+}
+
+bool ParallelBFS::isVisited(int cell) const {
+    return (visited[cell >> 6].load(std::memory_order_relaxed) >> (cell & 63)) & 1;
+}
+
+// Expand every frontier cell; the first thread to set a cell's visited bit owns it
+void ParallelBFS::topDownLevel(const CityGrid &grid, int level) {
+    size_t chunks = (frontier.size() + TOP_DOWN_CHUNK - 1) / TOP_DOWN_CHUNK;
+    chunkNext.resize(std::max(chunkNext.size(), chunks));
+    for (size_t i = 0; i < chunks; i++) {
+        chunkNext[i].clear();
+    }
+    pool.parallelFor(frontier.size(), TOP_DOWN_CHUNK, [&](size_t begin, size_t end) {
+        std::vector<int> &next = chunkNext[begin / TOP_DOWN_CHUNK];
+        for (size_t i = begin; i < end; i++) {
+            int current = frontier[i];
+            int row = current / cols;
+            int col = current % cols;
+            int neighbors[4] = {
+                col + 1 < cols ? current + 1 : -1,
+                col > 0 ? current - 1 : -1,
+                row + 1 < rows ? current + cols : -1,
+                row > 0 ? current - cols : -1
+            };
+            for (int cell : neighbors) {
+                if (cell < 0 || !grid.isPassable(cell) || isVisited(cell)) {
+                    continue;
+                }
+                uint64_t bit = uint64_t(1) << (cell & 63);
+                if (!(visited[cell >> 6].fetch_or(bit, std::memory_order_relaxed) & bit)) {
+                    distance[cell] = level + 1;
+                    next.push_back(cell);
+                }
+            }
+        }
+    });
+}
+
+// Let every unvisited open cell look for a frontier neighbor. Chunks are
+// whole bitset words, so each word is only ever written by one thread.
+void ParallelBFS::bottomUpLevel(const CityGrid &grid, int level) {
+    const std::vector<uint64_t> &blocked = grid.getBlockedBits();
+    size_t cellCount = grid.cellCount();
+    size_t chunks = (visitedWords + BOTTOM_UP_CHUNK - 1) / BOTTOM_UP_CHUNK;
+    chunkNext.resize(std::max(chunkNext.size(), chunks));
+    for (size_t i = 0; i < chunks; i++) {
+        chunkNext[i].clear();
+    }
+    auto onFrontier = [this](int cell) { return (frontierBits[cell >> 6] >> (cell & 63)) & 1; };
+
+    pool.parallelFor(visitedWords, BOTTOM_UP_CHUNK, [&](size_t begin, size_t end) {
+        std::vector<int> &next = chunkNext[begin / BOTTOM_UP_CHUNK];
+        for (size_t word = begin; word < end; word++) {
+            uint64_t candidates = ~visited[word].load(std::memory_order_relaxed) & ~blocked[word];
+            if (word == visitedWords - 1 && cellCount % 64 != 0) {
+                candidates &= (uint64_t(1) << (cellCount % 64)) - 1; // Bits past the last cell
+            }
+            uint64_t found = 0;
+            for (; candidates; candidates &= candidates - 1) {
+                int cell = static_cast<int>(word * 64 + __builtin_ctzll(candidates));
+                int row = cell / cols;
+                int col = cell % cols;
+                if ((col + 1 < cols && onFrontier(cell + 1)) || (col > 0 && onFrontier(cell - 1)) ||
+                    (row + 1 < rows && onFrontier(cell + cols)) || (row > 0 && onFrontier(cell - cols))) {
+                    distance[cell] = level + 1;
+                    found |= uint64_t(1) << (cell & 63);
+                    next.push_back(cell);
+                }
+            }
+            if (found) {
+                visited[word].fetch_or(found, std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+// The next frontier is the chunks' new cells in chunk order
+void ParallelBFS::mergeChunks() {
+    frontier.clear();
+    for (auto &next : chunkNext) {
+        frontier.insert(frontier.end(), next.begin(), next.end());
+        next.clear();
+    }
+}
+
+// Run levels until the target has a distance or nothing is left to reach
+bool ParallelBFS::search(const CityGrid &grid, int source, int target) {
+    prepare(grid);
+    size_t openCells = grid.cellCount();
+    for (uint64_t word : grid.getBlockedBits()) {
+        openCells -= __builtin_popcountll(word);
+    }
+    size_t unvisited = openCells;
+
+    distance[source] = 0;
+    visited[source >> 6].fetch_or(uint64_t(1) << (source & 63));
+    frontier.push_back(source);
+    bool bottomUp = false;
+    size_t previousSize = 0;
+
+    for (int level = 0; !frontier.empty(); level++) {
+        if (target >= 0 && distance[target] >= 0) {
+            break;
+        }
+        size_t frontierSize = frontier.size();
+        if (!bottomUp && frontierSize > previousSize && frontierSize * SWITCH_ALPHA > unvisited) {
+            bottomUp = true;
+        } else if (bottomUp && frontierSize < previousSize && frontierSize * SWITCH_BETA < openCells) {
+            bottomUp = false;
+        }
+        previousSize = frontierSize;
+
+        if (bottomUp) {
+            for (int cell : frontier) {
+                frontierBits[cell >> 6] |= uint64_t(1) << (cell & 63);
+            }
+            bottomUpLevel(grid, level);
+            for (int cell : frontier) {
+                frontierBits[cell >> 6] = 0; // Only frontier words were touched
+            }
+            bottomUpLevels++;
+        } else {
+            topDownLevel(grid, level);
+        }
+        mergeChunks();
+        unvisited -= std::min(unvisited, frontier.size());
+        levels++;
+    }
+    return target < 0 || distance[target] >= 0;
+}
+
+void ParallelBFS::computeDistanceField(const CityGrid &grid, std::pair<int, int> source) {
+    search(grid, grid.indexOf(source.first, source.second), -1);
+}
+
+int ParallelBFS::distanceAt(std::pair<int, int> cell) const {
+    if (cell.first < 0 || cell.first >= rows || cell.second < 0 || cell.second >= cols) {
+        return -1;
+    }
+    return distance[cell.first * cols + cell.second];
+}
+
+bool ParallelBFS::findPath(const CityGrid &grid, std::pair<int, int> start, std::pair<int, int> end,
+                           std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    int startIndex = grid.indexOf(start.first, start.second);
+    int endIndex = grid.indexOf(end.first, end.second);
+    if (!search(grid, startIndex, endIndex)) {
+        return false; // No path found
+    }
+
+    // Step back through cells one level closer to the start each time
+    int at = endIndex;
+    path.push_back(end);
+    while (at != startIndex) {
+        int row = at / cols;
+        int col = at % cols;
+        int neighbors[4] = {
+            col + 1 < cols ? at + 1 : -1,
+            col > 0 ? at - 1 : -1,
+            row + 1 < rows ? at + cols : -1,
+            row > 0 ? at - cols : -1
+        };
+        for (int next : neighbors) {
+            if (next >= 0 && distance[next] == distance[at] - 1) {
+                at = next;
+                break;
+            }
+        }
+        path.push_back({at / cols, at % cols});
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+int ParallelBFS::lastLevelCount() const {
+    return levels;
+}
+
+int ParallelBFS::lastBottomUpLevels() const {
+    return bottomUpLevels;
+}
+
+unsigned ParallelBFS::threadCount() const {
+    return pool.threadCount();
+}
@@ -0,0 +1,59 @@
+#ifndef PARALLEL_BFS_H
+#define PARALLEL_BFS_H
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "CityGrid.h"
+#include "WorkerPool.h"
+
+// Direction-optimizing, level-synchronous BFS for very large grids.
+// Every level runs on a WorkerPool. A top-down level splits the frontier
+// across threads; each thread claims unvisited neighbors with an atomic
+// fetch_or on the visited bitset. A bottom-up level instead splits the
+// grid and lets each unvisited cell look for a neighbor on the frontier.
+// That is cheaper once the frontier is a large share of what is left
+// (Beamer's heuristic). Levels complete in order, so the distances match
+// the sequential BFS exactly however the work is split.
+class ParallelBFS {
+private:
+    WorkerPool pool;
+    int rows;
+    int cols;
+    std::vector<int> distance;                       // Steps from the source, -1 if unreached
+    std::unique_ptr<std::atomic<uint64_t>[]> visited; // One bit per cell
+    size_t visitedWords;
+    std::vector<uint64_t> frontierBits;              // Frontier as a bitset, for bottom-up levels
+    std::vector<int> frontier;
+    std::vector<std::vector<int>> chunkNext;         // New cells per work chunk, merged in chunk order
+    int levels;
+    int bottomUpLevels;
+
+    void prepare(const CityGrid &grid);
+    bool isVisited(int cell) const;
+    void topDownLevel(const CityGrid &grid, int level);
+    void bottomUpLevel(const CityGrid &grid, int level);
+    void mergeChunks();
+    bool search(const CityGrid &grid, int source, int target);
+
+public:
+    // threadCount 0 uses all hardware threads
+    explicit ParallelBFS(unsigned threadCount = 0);
+
+    // Steps from `source` to every cell; distanceAt() reads the result
+    void computeDistanceField(const CityGrid &grid, std::pair<int, int> source);
+    // Steps from `cell` to the last source, -1 if unreachable
+    int distanceAt(std::pair<int, int> cell) const;
+    // Shortest path (start and end included), traced back along the distances
+    bool findPath(const CityGrid &grid, std::pair<int, int> start, std::pair<int, int> end,
+                  std::vector<std::pair<int, int>> &path);
+
+    int lastLevelCount() const;    // BFS levels run by the last query
+    int lastBottomUpLevels() const; // How many of them ran bottom-up
+    unsigned threadCount() const;
+};
+
+#endif // PARALLEL_BFS_H
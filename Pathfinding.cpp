@@ -0,0 +1,871 @@
+#include "Pathfinding.h"
+#include <algorithm> // For reverse, fill, min, max and heap operations
+#include <cstdlib>   // For abs
+
+// RingQueue definitions
+RingQueue::RingQueue() : mask(0), head(0), tail(0) {}
+
+void RingQueue::reserve(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if (size > buffer.size()) {
+        buffer.assign(size, 0);
+        mask = size - 1;
+    }
+    clear();
+}
+
+void RingQueue::clear() {
+    head = 0;
+    tail = 0;
+}
+
+bool RingQueue::empty() const {
+    return head == tail;
+}
+
+size_t RingQueue::size() const {
+    return tail - head;
+}
+
+void RingQueue::push(int value) {
+    buffer[tail & mask] = value;
+    tail++;
+}
+
+int RingQueue::pop() {
+    int value = buffer[head & mask];
+    head++;
+    return value;
+}
+
+// PathfindingContext definitions
+PathfindingContext::PathfindingContext()
+    : rows(0), cols(0), generation(0), cellOrder(CellOrder::RowMajor), fieldInSlots(false), expanded(0), rowWords(0), levelStamp(0) {}
+
+// Size the workspace for the grid and start a new generation
+void PathfindingContext::prepare(int gridRows, int gridCols) {
+    if (gridRows != rows || gridCols != cols || layout.getOrder() != cellOrder) {
+        rows = gridRows;
+        cols = gridCols;
+        layout.reset(rows, cols, cellOrder);
+        slotSourceBits.clear(); // Slot bits are rebuilt by the next syncSlotBits
+        jumpSourceBits.clear(); // And the jump tables by the next syncJumpTables
+        openSourceBits.clear(); // And the bitboard by the next loadBitboard
+    }
+    size_t cellCount = layout.slotCount(); // At least rows * cols
+    if (visitStamp.size() != cellCount) {
+        visitStamp.assign(cellCount, 0);
+        closedStamp.assign(cellCount, 0);
+        parent.assign(cellCount, -1);
+        gCost.assign(cellCount, 0);
+        entryCost.clear(); // Sized by the first weighted search
+        generation = 0;
+    }
+    frontier.reserve(cellCount); // Every cell is enqueued at most once
+    openHeap.clear();
+    expanded = 0;
+
+    generation++;
+    if (generation == 0) { // Stamp wrapped around, old marks would look fresh
+        std::fill(visitStamp.begin(), visitStamp.end(), 0);
+        std::fill(closedStamp.begin(), closedStamp.end(), 0);
+        generation = 1;
+    }
+}
+
+// Walk the parent links back from the end cell.
+// Linked cells may be a straight jump apart, the cells in between are filled in.
+void PathfindingContext::reconstructPath(int startIndex, int endIndex, std::vector<std::pair<int, int>> &path) const {
+    path.clear();
+    for (int at = endIndex; at != startIndex; at = parent[at]) {
+        int row = at / cols, col = at % cols;
+        int parentRow = parent[at] / cols, parentCol = parent[at] % cols;
+        int dRow = (parentRow > row) - (parentRow < row);
+        int dCol = (parentCol > col) - (parentCol < col);
+        while (row != parentRow || col != parentCol) {
+            path.push_back({row, col});
+            row += dRow;
+            col += dCol;
+        }
+    }
+    path.push_back({startIndex / cols, startIndex % cols});
+    std::reverse(path.begin(), path.end());
+}
+
+// Walk the parent links of adjacent slots back from the end slot
+void PathfindingContext::reconstructSlotPath(int startSlot, int endSlot, std::vector<std::pair<int, int>> &path) const {
+    path.clear();
+    for (int at = endSlot; at != startSlot; at = parent[at]) {
+        path.push_back(layout.cellOf(at));
+    }
+    path.push_back(layout.cellOf(startSlot));
+    std::reverse(path.begin(), path.end());
+}
+
+// Bring the slot-ordered passable bits in line with the grid. Only words of
+// obstacle bits that differ from the last copy are walked, so an unchanged
+// grid costs one compare per 64 cells.
+void PathfindingContext::syncSlotBits(const CityGrid &grid) {
+    if (layout.getOrder() == CellOrder::RowMajor) {
+        return; // Searches read the grid's own bits
+    }
+    const std::vector<uint64_t> &blocked = grid.getBlockedBits();
+    if (slotSourceBits.size() != blocked.size()) {
+        slotOpenBits.assign((layout.slotCount() + 63) / 64, 0); // Padding stays blocked
+        slotSourceBits.assign(blocked.size(), ~0ULL);           // So every open cell shows up as a change
+    }
+    int cellCount = rows * cols;
+    for (size_t word = 0; word < blocked.size(); word++) {
+        uint64_t changed = blocked[word] ^ slotSourceBits[word];
+        while (changed != 0) {
+            int bit = __builtin_ctzll(changed);
+            changed &= changed - 1;
+            int index = static_cast<int>(word * 64) + bit;
+            if (index >= cellCount) {
+                break;
+            }
+            int slot = layout.slotOf(index / cols, index % cols);
+            if ((blocked[word] >> bit) & 1) {
+                slotOpenBits[slot >> 6] &= ~(1ULL << (slot & 63));
+            } else {
+                slotOpenBits[slot >> 6] |= 1ULL << (slot & 63);
+            }
+        }
+        slotSourceBits[word] = blocked[word];
+    }
+}
+
+void PathfindingContext::setCellOrder(CellOrder order) {
+    cellOrder = order; // Applied by the next prepare()
+}
+
+// Breadth-first search from start to end, over slots of the cell layout
+bool PathfindingContext::findPath(const CityGrid &grid,
+                                  std::pair<int, int> start, std::pair<int, int> end,
+                                  std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    prepare(grid.getRows(), grid.getCols());
+    syncSlotBits(grid);
+
+    int startIndex = layout.slotOf(start.first, start.second);
+    int endIndex = layout.slotOf(end.first, end.second);
+    visitStamp[startIndex] = generation;
+    frontier.push(startIndex);
+
+    while (!frontier.empty()) {
+        int current = frontier.pop();
+        expanded++;
+        if (current == endIndex) {
+            reconstructSlotPath(startIndex, endIndex, path);
+            return true;
+        }
+
+        // Neighbors in the same order as the original BFS: right, left, down, up
+        int neighbors[4];
+        layout.neighborsOf(current, neighbors);
+        for (int next : neighbors) {
+            if (next >= 0 && visitStamp[next] != generation && isOpenSlot(grid, next)) {
+                visitStamp[next] = generation;
+                parent[next] = current;
+                frontier.push(next);
+            }
+        }
+    }
+    return false; // No path found
+}
+
+// Multi-target BFS: one pass gives the distance from every cell to the source.
+// Distances live in gCost by slot and are only valid where visitStamp is current.
+void PathfindingContext::computeDistanceField(const CityGrid &grid, std::pair<int, int> source) {
+    prepare(grid.getRows(), grid.getCols());
+    syncSlotBits(grid);
+    fieldInSlots = true;
+
+    int sourceIndex = layout.slotOf(source.first, source.second);
+    visitStamp[sourceIndex] = generation;
+    gCost[sourceIndex] = 0;
+    frontier.push(sourceIndex);
+
+    while (!frontier.empty()) {
+        int current = frontier.pop();
+        expanded++;
+        int neighbors[4];
+        layout.neighborsOf(current, neighbors);
+        for (int next : neighbors) {
+            if (next >= 0 && visitStamp[next] != generation && isOpenSlot(grid, next)) {
+                visitStamp[next] = generation;
+                gCost[next] = gCost[current] + 1;
+                frontier.push(next);
+            }
+        }
+    }
+}
+
+int PathfindingContext::fieldDistance(std::pair<int, int> cell) const {
+    if (cell.first < 0 || cell.first >= rows || cell.second < 0 || cell.second >= cols) {
+        return -1;
+    }
+    int index = fieldInSlots ? layout.slotOf(cell.first, cell.second) : cell.first * cols + cell.second;
+    return visitStamp[index] == generation ? gCost[index] : -1;
+}
+
+// Ordering for the open list: lowest f first, ties go to the deeper node
+static bool openEntryLess(const OpenEntry &a, const OpenEntry &b) {
+    return a.f > b.f || (a.f == b.f && a.g < b.g);
+}
+
+// Add a cell to the open list with its Manhattan heuristic
+void PathfindingContext::pushOpen(int index, int g, int target) {
+    int h = std::abs(index / cols - target / cols) + std::abs(index % cols - target % cols);
+    openHeap.push_back({g + h, g, index});
+    std::push_heap(openHeap.begin(), openHeap.end(), openEntryLess);
+}
+
+// A* search, 4-connected with unit step cost
+bool PathfindingContext::findPathAStar(const CityGrid &grid,
+                                       std::pair<int, int> start, std::pair<int, int> end,
+                                       std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    prepare(grid.getRows(), grid.getCols());
+
+    int startIndex = start.first * cols + start.second;
+    int endIndex = end.first * cols + end.second;
+    visitStamp[startIndex] = generation;
+    gCost[startIndex] = 0;
+    pushOpen(startIndex, 0, endIndex);
+
+    while (!openHeap.empty()) {
+        std::pop_heap(openHeap.begin(), openHeap.end(), openEntryLess);
+        OpenEntry entry = openHeap.back();
+        openHeap.pop_back();
+        int current = entry.index;
+        if (closedStamp[current] == generation || entry.g > gCost[current]) {
+            continue; // Stale entry
+        }
+        closedStamp[current] = generation;
+        expanded++;
+
+        if (current == endIndex) {
+            reconstructPath(startIndex, endIndex, path);
+            return true;
+        }
+
+        int row = current / cols;
+        int col = current % cols;
+        int neighbors[4] = {
+            col + 1 < cols ? current + 1 : -1,
+            col > 0 ? current - 1 : -1,
+            row + 1 < rows ? current + cols : -1,
+            row > 0 ? current - cols : -1
+        };
+        for (int next : neighbors) {
+            if (next < 0 || !grid.isPassable(next) || closedStamp[next] == generation) {
+                continue;
+            }
+            int g = entry.g + 1;
+            if (visitStamp[next] != generation || g < gCost[next]) {
+                visitStamp[next] = generation;
+                gCost[next] = g;
+                parent[next] = current;
+                pushOpen(next, g, endIndex);
+            }
+        }
+    }
+    return false; // No path found
+}
+
+// Helper for the jump functions: out-of-bounds cells count as blocked
+static bool isOpenCell(const CityGrid &grid, int row, int col) {
+    return grid.inBounds(row, col) && grid.isPassable(row, col);
+}
+
+// Fill in the jump tables of one row. Shortest paths are kept in
+// vertical-first canonical form, so a horizontal run only stops where a
+// vertical step is forced because the cell diagonally behind it is blocked.
+// A run depends on its own row and the rows above and below.
+void PathfindingContext::buildJumpRow(const CityGrid &grid, int row) {
+    auto forced = [&grid, row](int col, int dCol) {
+        for (int dRow = -1; dRow <= 1; dRow += 2) {
+            if (isOpenCell(grid, row + dRow, col) && !isOpenCell(grid, row + dRow, col - dCol)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    int base = row * cols;
+    for (int col = cols - 1; col >= 0; col--) { // Each cell continues the run of its right neighbor
+        int next = col + 1;
+        int &entry = jumpRight[base + col];
+        if (!isOpenCell(grid, row, next)) {
+            entry = -1;
+        } else if (forced(next, 1)) {
+            entry = 1;
+        } else {
+            int onward = jumpRight[base + next];
+            entry = onward > 0 ? onward + 1 : onward - 1;
+        }
+    }
+    for (int col = 0; col < cols; col++) {
+        int next = col - 1;
+        int &entry = jumpLeft[base + col];
+        if (!isOpenCell(grid, row, next)) {
+            entry = -1;
+        } else if (forced(next, -1)) {
+            entry = 1;
+        } else {
+            int onward = jumpLeft[base + next];
+            entry = onward > 0 ? onward + 1 : onward - 1;
+        }
+    }
+}
+
+// Rebuild the jump tables of the rows next to cells whose obstacle bit
+// changed since the last JPS query; the first query builds every row
+void PathfindingContext::syncJumpTables(const CityGrid &grid) {
+    const std::vector<uint64_t> &blocked = grid.getBlockedBits();
+    if (jumpSourceBits.size() != blocked.size() || jumpRight.size() != static_cast<size_t>(rows) * cols) {
+        jumpRight.assign(static_cast<size_t>(rows) * cols, -1);
+        jumpLeft.assign(static_cast<size_t>(rows) * cols, -1);
+        for (int row = 0; row < rows; row++) {
+            buildJumpRow(grid, row);
+        }
+        jumpSourceBits = blocked;
+        return;
+    }
+    int lastBuilt = -2; // Changed cells come in index order, so rows are too
+    for (size_t word = 0; word < blocked.size(); word++) {
+        uint64_t changed = blocked[word] ^ jumpSourceBits[word];
+        while (changed != 0) {
+            int index = static_cast<int>(word * 64) + __builtin_ctzll(changed);
+            changed &= changed - 1;
+            int row = index / cols;
+            for (int r = std::max(std::max(row - 1, 0), lastBuilt + 1); r <= row + 1 && r < rows; r++) {
+                buildJumpRow(grid, r);
+                lastBuilt = r;
+            }
+        }
+        jumpSourceBits[word] = blocked[word];
+    }
+}
+
+// Horizontal jump from (row, col), read from the jump tables in O(1).
+// Returns the target if the run passes it, else the jump point, -1 if none.
+int PathfindingContext::jumpHorizontal(int row, int col, int dCol, int target) const {
+    int index = row * cols + col;
+    int entry = dCol > 0 ? jumpRight[index] : jumpLeft[index];
+    int reach = entry > 0 ? entry : -entry - 1; // Open cells the run crosses
+    if (target / cols == row) {
+        int offset = (target % cols - col) * dCol;
+        if (offset > 0 && offset <= reach) {
+            return target;
+        }
+    }
+    return entry > 0 ? index + entry * dCol : -1;
+}
+
+// Jump along a column. Every vertical step keeps both horizontal moves
+// natural, so a cell is a jump point when a horizontal jump from it succeeds.
+int PathfindingContext::jumpVertical(const CityGrid &grid, int row, int col, int dRow, int target) const {
+    while (true) {
+        row += dRow;
+        if (!isOpenCell(grid, row, col)) {
+            return -1;
+        }
+        int index = row * cols + col;
+        if (index == target ||
+            jumpHorizontal(row, col, 1, target) >= 0 ||
+            jumpHorizontal(row, col, -1, target) >= 0) {
+            return index;
+        }
+    }
+}
+
+// Jump Point Search: A* over jump points with straight-line segment costs
+bool PathfindingContext::findPathJPS(const CityGrid &grid,
+                                     std::pair<int, int> start, std::pair<int, int> end,
+                                     std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    prepare(grid.getRows(), grid.getCols());
+    syncJumpTables(grid);
+
+    int startIndex = start.first * cols + start.second;
+    int endIndex = end.first * cols + end.second;
+    visitStamp[startIndex] = generation;
+    gCost[startIndex] = 0;
+    pushOpen(startIndex, 0, endIndex);
+
+    while (!openHeap.empty()) {
+        std::pop_heap(openHeap.begin(), openHeap.end(), openEntryLess);
+        OpenEntry entry = openHeap.back();
+        openHeap.pop_back();
+        int current = entry.index;
+        if (closedStamp[current] == generation || entry.g > gCost[current]) {
+            continue; // Stale entry
+        }
+        closedStamp[current] = generation;
+        expanded++;
+
+        if (current == endIndex) {
+            reconstructPath(startIndex, endIndex, path);
+            return true;
+        }
+
+        int row = current / cols;
+        int col = current % cols;
+
+        // Directions to jump in: {dRow, dCol}
+        int directions[4][2];
+        int directionCount = 0;
+        if (current == startIndex) {
+            int all[4][2] = {{0, 1}, {0, -1}, {1, 0}, {-1, 0}};
+            for (auto &d : all) {
+                directions[directionCount][0] = d[0];
+                directions[directionCount][1] = d[1];
+                directionCount++;
+            }
+        } else {
+            int parentRow = parent[current] / cols, parentCol = parent[current] % cols;
+            int dRow = (row > parentRow) - (row < parentRow);
+            int dCol = (col > parentCol) - (col < parentCol);
+            if (dRow != 0) { // Vertical: straight on and both horizontals are natural
+                int natural[3][2] = {{dRow, 0}, {0, 1}, {0, -1}};
+                for (auto &d : natural) {
+                    directions[directionCount][0] = d[0];
+                    directions[directionCount][1] = d[1];
+                    directionCount++;
+                }
+            } else { // Horizontal: straight on plus forced vertical turns
+                directions[directionCount][0] = 0;
+                directions[directionCount][1] = dCol;
+                directionCount++;
+                for (int turn = -1; turn <= 1; turn += 2) {
+                    if (isOpenCell(grid, row + turn, col) &&
+                        !isOpenCell(grid, row + turn, col - dCol)) {
+                        directions[directionCount][0] = turn;
+                        directions[directionCount][1] = 0;
+                        directionCount++;
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < directionCount; i++) {
+            int next = directions[i][0] != 0
+                ? jumpVertical(grid, row, col, directions[i][0], endIndex)
+                : jumpHorizontal(row, col, directions[i][1], endIndex);
+            if (next < 0 || closedStamp[next] == generation) {
+                continue;
+            }
+            int g = entry.g + std::abs(next / cols - row) + std::abs(next % cols - col);
+            if (visitStamp[next] != generation || g < gCost[next]) {
+                visitStamp[next] = generation;
+                gCost[next] = g;
+                parent[next] = current;
+                pushOpen(next, g, endIndex);
+            }
+        }
+    }
+    return false; // No path found
+}
+
+void PathfindingContext::setTraversalCosts(const TraversalCosts &costs) {
+    traversalCosts.road = std::max(1, costs.road);
+    traversalCosts.trafficSignal = std::max(1, costs.trafficSignal);
+    traversalCosts.congestionZone = std::max(1, costs.congestionZone);
+}
+
+// Dijkstra with Dial's bucket queue. Step costs lie in [1, maxCost], so every
+// queued cell sits less than maxCost + 1 above the cost being processed and a
+// ring of maxCost + 1 buckets holds the whole open list. Pushes and pops are
+// O(1); a cell may be queued more than once and stale copies are skipped.
+// A cell's cost is looked up in the grid layers once, on its first visit.
+// A forward search pays for the cell being entered. A reverse search (for cost
+// fields) walks the same moves backwards, so it pays for the cell it leaves.
+bool PathfindingContext::runDial(const CityGrid &grid, int source, int target, bool reverse) {
+    int maxCost = std::max(traversalCosts.road, std::max(traversalCosts.trafficSignal, traversalCosts.congestionZone));
+    size_t span = static_cast<size_t>(maxCost) + 1;
+    if (costBuckets.size() < span) {
+        costBuckets.resize(span);
+    }
+    for (auto &bucket : costBuckets) {
+        bucket.clear();
+    }
+    if (entryCost.size() != visitStamp.size()) {
+        entryCost.assign(visitStamp.size(), 0);
+    }
+
+    visitStamp[source] = generation;
+    gCost[source] = 0;
+    entryCost[source] = grid.traversalCost(source, traversalCosts);
+    costBuckets[0].push_back(source);
+    size_t pending = 1;
+
+    for (int cost = 0; pending > 0; cost++) {
+        std::vector<int> &bucket = costBuckets[cost % span];
+        for (size_t k = 0; k < bucket.size(); k++) {
+            int current = bucket[k];
+            pending--;
+            if (closedStamp[current] == generation || gCost[current] != cost) {
+                continue; // Stale entry
+            }
+            closedStamp[current] = generation;
+            expanded++;
+            if (current == target) {
+                return true;
+            }
+
+            int row = current / cols;
+            int col = current % cols;
+            int neighbors[4] = {
+                col + 1 < cols ? current + 1 : -1,
+                col > 0 ? current - 1 : -1,
+                row + 1 < rows ? current + cols : -1,
+                row > 0 ? current - cols : -1
+            };
+            for (int next : neighbors) {
+                if (next < 0 || !grid.isPassable(next) || closedStamp[next] == generation) {
+                    continue;
+                }
+                bool seen = visitStamp[next] == generation;
+                if (!seen) {
+                    entryCost[next] = grid.traversalCost(next, traversalCosts);
+                }
+                int g = cost + entryCost[reverse ? current : next];
+                if (!seen || g < gCost[next]) {
+                    visitStamp[next] = generation;
+                    gCost[next] = g;
+                    parent[next] = current;
+                    costBuckets[g % span].push_back(next);
+                    pending++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    return false; // Target not reached (or none was given)
+}
+
+// Least-cost search honoring signal and congestion costs
+bool PathfindingContext::findPathWeighted(const CityGrid &grid,
+                                          std::pair<int, int> start, std::pair<int, int> end,
+                                          std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    prepare(grid.getRows(), grid.getCols());
+
+    int startIndex = start.first * cols + start.second;
+    int endIndex = end.first * cols + end.second;
+    if (!runDial(grid, startIndex, endIndex, false)) {
+        return false; // No path found
+    }
+    reconstructPath(startIndex, endIndex, path);
+    return true;
+}
+
+// Reverse weighted flood, costs live in gCost like computeDistanceField
+void PathfindingContext::computeCostField(const CityGrid &grid, std::pair<int, int> source) {
+    prepare(grid.getRows(), grid.getCols());
+    fieldInSlots = false; // The weighted searches index cells row-major
+    runDial(grid, source.first * cols + source.second, -1, true);
+}
+
+// Copy one row-aligned word of passable cells out of the grid's flat obstacle bits
+void PathfindingContext::loadOpenWord(const std::vector<uint64_t> &blocked, int row, int word) {
+    size_t offset = static_cast<size_t>(row) * cols + static_cast<size_t>(word) * 64;
+    size_t source = offset >> 6;
+    int shift = offset & 63;
+    uint64_t bits = blocked[source] >> shift;
+    if (shift != 0 && source + 1 < blocked.size()) {
+        bits |= blocked[source + 1] << (64 - shift);
+    }
+    int valid = std::min(64, cols - word * 64);
+    uint64_t mask = valid == 64 ? ~uint64_t(0) : (uint64_t(1) << valid) - 1;
+    openBits[static_cast<size_t>(row) * rowWords + word] = ~bits & mask;
+}
+
+// Bring the row-aligned passable words in line with the grid and clear the
+// bits the last query set. Like syncSlotBits, only words of obstacle bits
+// that differ from the last copy are reloaded, and only the words the last
+// query's levels reached are cleared.
+void PathfindingContext::loadBitboard(const CityGrid &grid) {
+    rowWords = (cols + 63) / 64;
+    size_t wordCount = static_cast<size_t>(rows) * rowWords;
+    const std::vector<uint64_t> &blocked = grid.getBlockedBits();
+    if (openBits.size() != wordCount || openSourceBits.size() != blocked.size()) {
+        openBits.assign(wordCount, 0);
+        nextBits.assign(wordCount, 0);
+        visitedBits.assign(wordCount, 0);
+        levelLowBits.assign(wordCount, 0);
+        levelHighBits.assign(wordCount, 0);
+        wordStamp.assign(wordCount, 0);
+        levelStamp = 0;
+        frontierWords.clear();
+        for (int row = 0; row < rows; row++) {
+            for (int word = 0; word < rowWords; word++) {
+                loadOpenWord(blocked, row, word);
+            }
+        }
+        openSourceBits = blocked;
+        return;
+    }
+
+    int cellCount = rows * cols;
+    for (size_t source = 0; source < blocked.size(); source++) {
+        if (blocked[source] == openSourceBits[source]) {
+            continue;
+        }
+        // Reload the row words that overlap the 64 cells of this word
+        int first = static_cast<int>(source * 64);
+        int last = std::min(first + 63, cellCount - 1);
+        for (int row = first / cols; row <= last / cols; row++) {
+            int fromCol = row == first / cols ? first % cols : 0;
+            int toCol = row == last / cols ? last % cols : cols - 1;
+            for (int word = fromCol / 64; word <= toCol / 64; word++) {
+                loadOpenWord(blocked, row, word);
+            }
+        }
+        openSourceBits[source] = blocked[source];
+    }
+
+    for (const auto &entry : frontierWords) {
+        visitedBits[entry.first] = 0;
+        levelLowBits[entry.first] = 0;
+        levelHighBits[entry.first] = 0;
+    }
+    frontierWords.clear();
+    if (levelStamp > UINT32_MAX - static_cast<uint32_t>(cellCount) - 1) {
+        wordStamp.assign(wordCount, 0); // A query has at most one level per cell
+        levelStamp = 0;
+    }
+}
+
+// Add candidate cells to a word of the next level, keeping only open unvisited ones
+void PathfindingContext::spreadToWord(int word, uint64_t bits) {
+    bits &= openBits[word] & ~visitedBits[word];
+    if (!bits) {
+        return;
+    }
+    if (wordStamp[word] != levelStamp) {
+        wordStamp[word] = levelStamp;
+        nextBits[word] = 0;
+        nextWords.push_back(word);
+    }
+    nextBits[word] |= bits;
+}
+
+// Level-synchronous BFS over row bitsets
+bool PathfindingContext::findPathBitboard(const CityGrid &grid,
+                                          std::pair<int, int> start, std::pair<int, int> end,
+                                          std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    prepare(grid.getRows(), grid.getCols());
+    loadBitboard(grid);
+
+    int startIndex = start.first * cols + start.second;
+    int endIndex = end.first * cols + end.second;
+    int endWord = end.first * rowWords + end.second / 64;
+    uint64_t endBit = uint64_t(1) << (end.second & 63);
+    int startWord = start.first * rowWords + start.second / 64;
+    int wordCount = rows * rowWords;
+
+    visitedBits[startWord] |= uint64_t(1) << (start.second & 63); // Level 0
+    frontierWords.push_back({startWord, uint64_t(1) << (start.second & 63)});
+    size_t levelBegin = 0; // The current level is frontierWords[levelBegin..]
+    bool found = startIndex == endIndex;
+
+    for (uint32_t level = 1; !found && levelBegin < frontierWords.size(); level++) {
+        nextWords.clear();
+        levelStamp++;
+        size_t levelEnd = frontierWords.size();
+        for (size_t i = levelBegin; i < levelEnd; i++) {
+            int word = frontierWords[i].first;
+            uint64_t bits = frontierWords[i].second;
+            expanded += __builtin_popcountll(bits);
+            int column = word % rowWords;
+            spreadToWord(word, (bits << 1) | (bits >> 1));
+            if (column + 1 < rowWords) spreadToWord(word + 1, bits >> 63);
+            if (column > 0) spreadToWord(word - 1, bits << 63);
+            if (word >= rowWords) spreadToWord(word - rowWords, bits);
+            if (word + rowWords < wordCount) spreadToWord(word + rowWords, bits);
+        }
+
+        // Commit the new level, tagging its cells with level mod 3
+        uint32_t phase = level % 3;
+        levelBegin = levelEnd;
+        for (int word : nextWords) {
+            uint64_t bits = nextBits[word];
+            visitedBits[word] |= bits;
+            frontierWords.push_back({word, bits});
+            if (phase & 1) levelLowBits[word] |= bits;
+            if (phase & 2) levelHighBits[word] |= bits;
+            if (word == endWord && (bits & endBit)) {
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        return false; // No path found
+    }
+
+    // Step back through cells one level closer to the start each time.
+    // Visited neighbors are at most one level apart, so level mod 3 is
+    // enough to tell which of them is the closer one.
+    auto phaseOf = [this](int cell) {
+        int word = (cell / cols) * rowWords + (cell % cols) / 64;
+        int bit = (cell % cols) & 63;
+        return static_cast<int>(((levelLowBits[word] >> bit) & 1) | (((levelHighBits[word] >> bit) & 1) << 1));
+    };
+    auto isVisited = [this](int cell) {
+        int col = cell % cols;
+        return (visitedBits[(cell / cols) * rowWords + col / 64] >> (col & 63)) & 1;
+    };
+    int at = endIndex;
+    path.push_back(end);
+    while (at != startIndex) {
+        int previousPhase = (phaseOf(at) + 2) % 3;
+        int row = at / cols;
+        int col = at % cols;
+        int neighbors[4] = {
+            col + 1 < cols ? at + 1 : -1,
+            col > 0 ? at - 1 : -1,
+            row + 1 < rows ? at + cols : -1,
+            row > 0 ? at - cols : -1
+        };
+        for (int next : neighbors) {
+            if (next >= 0 && isVisited(next) && phaseOf(next) == previousPhase) {
+                at = next;
+                break;
+            }
+        }
+        path.push_back({at / cols, at % cols});
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+// Level-synchronous BFS from the start and from the end
+bool PathfindingContext::findPathBidirectional(const CityGrid &grid,
+                                               std::pair<int, int> start, std::pair<int, int> end,
+                                               std::vector<std::pair<int, int>> &path) {
+    path.clear();
+    prepare(grid.getRows(), grid.getCols());
+    size_t cellCount = static_cast<size_t>(rows) * cols;
+    if (backParent.size() != cellCount) {
+        backParent.assign(cellCount, -1);
+    }
+    backFrontier.reserve(cellCount);
+
+    int startIndex = start.first * cols + start.second;
+    int endIndex = end.first * cols + end.second;
+    if (startIndex == endIndex) {
+        path.push_back(start);
+        return true;
+    }
+    if (!grid.isPassable(endIndex)) {
+        return false; // The end can never be entered
+    }
+    visitStamp[startIndex] = generation;
+    frontier.push(startIndex);
+    closedStamp[endIndex] = generation;
+    backParent[endIndex] = -1;
+    backFrontier.push(endIndex);
+
+    // A cell reached from both sides is where the searches meet.
+    // Each level is finished before the other side moves, so the first
+    // meeting is on a shortest path: every meeting on that level adds up
+    // to the same length, and no earlier level had one.
+    int meeting = -1;
+    auto expandLevel = [&](bool forward) {
+        RingQueue &queue = forward ? frontier : backFrontier;
+        for (size_t count = queue.size(); count > 0 && meeting < 0; count--) {
+            int current = queue.pop();
+            expanded++;
+            int row = current / cols;
+            int col = current % cols;
+            int neighbors[4] = {
+                col + 1 < cols ? current + 1 : -1,
+                col > 0 ? current - 1 : -1,
+                row + 1 < rows ? current + cols : -1,
+                row > 0 ? current - cols : -1
+            };
+            for (int next : neighbors) {
+                if (next < 0) {
+                    continue;
+                }
+                if (forward) {
+                    // Moving forward enters `next`
+                    if (visitStamp[next] == generation || !grid.isPassable(next)) {
+                        continue;
+                    }
+                    visitStamp[next] = generation;
+                    parent[next] = current;
+                    frontier.push(next);
+                } else {
+                    // Moving backward means `next` steps into `current`; only the start may be blocked
+                    if (closedStamp[next] == generation || (!grid.isPassable(next) && next != startIndex)) {
+                        continue;
+                    }
+                    closedStamp[next] = generation;
+                    backParent[next] = current;
+                    backFrontier.push(next);
+                }
+                if (visitStamp[next] == generation && closedStamp[next] == generation) {
+                    meeting = next;
+                    return;
+                }
+            }
+        }
+    };
+
+    while (meeting < 0 && !frontier.empty() && !backFrontier.empty()) {
+        expandLevel(frontier.size() <= backFrontier.size());
+    }
+    if (meeting < 0) {
+        return false; // No path found
+    }
+
+    reconstructPath(startIndex, meeting, path);
+    for (int at = backParent[meeting]; at >= 0; at = backParent[at]) {
+        path.push_back({at / cols, at % cols});
+    }
+    return true;
+}
+
+// Hierarchical search over the cluster graph
+bool PathfindingContext::findPathHierarchical(const CityGrid &grid,
+                                              std::pair<int, int> start, std::pair<int, int> end,
+                                              std::vector<std::pair<int, int>> &path) {
+    hierarchy.sync(grid);
+    bool found = hierarchy.findPath(grid, start, end, path);
+    expanded = hierarchy.lastExpandedCount();
+    return found;
+}
+
+// Run the selected search engine
+bool PathfindingContext::findPath(PathEngine engine, const CityGrid &grid,
+                                  std::pair<int, int> start, std::pair<int, int> end,
+                                  std::vector<std::pair<int, int>> &path) {
+    switch (engine) {
+    case PathEngine::AStar:
+        return findPathAStar(grid, start, end, path);
+    case PathEngine::JumpPoint:
+        return findPathJPS(grid, start, end, path);
+    case PathEngine::Weighted:
+        return findPathWeighted(grid, start, end, path);
+    case PathEngine::Bitboard:
+        return findPathBitboard(grid, start, end, path);
+    case PathEngine::Hierarchical:
+        return findPathHierarchical(grid, start, end, path);
+    case PathEngine::Bidirectional:
+        return findPathBidirectional(grid, start, end, path);
+    case PathEngine::BFS:
+    default:
+        return findPath(grid, start, end, path);
+    }
+}
+
+int PathfindingContext::lastExpandedCount() const {
+    return expanded;
+}
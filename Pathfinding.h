@@ -0,0 +1,203 @@
+#ifndef PATHFINDING_H
+#define PATHFINDING_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "CityGrid.h"
+#include "HierarchicalGraph.h"
+#include "CellLayout.h"
+
+// Search algorithm used for grid routing
+enum class PathEngine {
+    BFS,      // Uninformed breadth-first search
+    AStar,    // A* with the Manhattan distance heuristic
+    JumpPoint, // Jump Point Search for 4-connected grids, run on top of A*
+    Weighted,  // Least traversal cost (see TraversalCosts) with Dial's bucket queue
+    Bitboard,  // BFS that expands 64 cells per word operation over row bitsets
+    Hierarchical, // HPA* over cached cluster entrances, near-optimal
+    Bidirectional // BFS from both ends that stops where the frontiers meet
+};
+
+// Fixed-capacity FIFO of cell indices backed by a power-of-two ring buffer
+class RingQueue {
+private:
+    std::vector<int> buffer;
+    size_t mask;
+    size_t head;
+    size_t tail;
+
+public:
+    RingQueue();
+    void reserve(size_t capacity); // Only allocates when capacity grows
+    void clear();
+    bool empty() const;
+    size_t size() const;
+    void push(int value);
+    int pop();
+};
+
+// Open list entry for the informed searches
+struct OpenEntry {
+    int f;     // g + heuristic
+    int g;     // Cost from the start
+    int index;
+};
+
+// Reusable workspace for grid searches.
+// All per-cell arrays are flat (index = row * cols + col) and sized once per
+// grid size. Visited marks are generation stamps, so a new query only bumps
+// the generation instead of clearing the arrays, and a warmed-up context
+// performs no heap allocation per query.
+class PathfindingContext {
+private:
+    int rows;
+    int cols;
+    std::vector<uint32_t> visitStamp; // Cell is visited when stamp == generation
+    std::vector<int> parent;          // Flat index of the cell we came from
+    RingQueue frontier;
+    uint32_t generation;
+
+    // Slot order of the arrays for BFS and computeDistanceField; the other
+    // searches index them row-major (the arrays are sized for either)
+    CellOrder cellOrder;
+    CellLayout layout;
+    std::vector<uint64_t> slotOpenBits;   // Passable cells by slot, ZOrder only
+    std::vector<uint64_t> slotSourceBits; // Grid obstacle bits slotOpenBits was built from
+    bool fieldInSlots;                    // The last distance field is stored by slot
+
+    // Open list state for the informed searches
+    std::vector<int> gCost;           // Valid when visitStamp == generation
+    std::vector<uint32_t> closedStamp; // Cell is closed when stamp == generation
+    std::vector<OpenEntry> openHeap;
+    int expanded;
+
+    // Weighted search state
+    TraversalCosts traversalCosts;
+    std::vector<std::vector<int>> costBuckets; // Dial's circular buckets, one per cost mod (max cost + 1)
+    std::vector<int> entryCost;                // Cost of entering a cell, valid once it is visited
+
+    // Bitboard search state: one bit per cell, each row padded to whole words
+    int rowWords;
+    std::vector<uint64_t> openBits;     // Passable cells
+    std::vector<uint64_t> openSourceBits; // Grid obstacle bits openBits was built from
+    std::vector<uint64_t> visitedBits;
+    std::vector<uint64_t> levelLowBits;  // Level mod 3 of each visited cell, low bit
+    std::vector<uint64_t> levelHighBits; // and high bit
+    std::vector<uint64_t> nextBits;     // Cells reached on the next level
+    std::vector<uint32_t> wordStamp;    // Word is in nextWords when stamp == levelStamp
+    uint32_t levelStamp;                // Counts levels across queries
+    std::vector<std::pair<int, uint64_t>> frontierWords; // Every level so far as (word, bits)
+    std::vector<int> nextWords;         // Words with bits in nextBits
+
+    // Jump Point Search tables, kept in step with the grid by syncJumpTables.
+    // Per cell, the horizontal jump to the right (left) ends d cells away:
+    // +d at a jump point, -d where it hits a blocked cell or the map edge.
+    std::vector<int> jumpRight;
+    std::vector<int> jumpLeft;
+    std::vector<uint64_t> jumpSourceBits; // Grid obstacle bits the tables were built from
+
+    // Bidirectional search state for the half that starts at the end.
+    // Cells it reached are marked in closedStamp.
+    RingQueue backFrontier;
+    std::vector<int> backParent; // Next cell toward the end
+
+    // Hierarchical search state, kept in step with the grid by sync()
+    HierarchicalGraph hierarchy;
+
+    void prepare(int gridRows, int gridCols);
+    void reconstructPath(int startIndex, int endIndex, std::vector<std::pair<int, int>> &path) const;
+    void reconstructSlotPath(int startSlot, int endSlot, std::vector<std::pair<int, int>> &path) const;
+    void syncSlotBits(const CityGrid &grid);
+    bool isOpenSlot(const CityGrid &grid, int slot) const {
+        return layout.getOrder() == CellOrder::RowMajor ? grid.isPassable(slot)
+                                                        : (slotOpenBits[slot >> 6] >> (slot & 63)) & 1;
+    }
+    void pushOpen(int index, int g, int target);
+    void syncJumpTables(const CityGrid &grid);
+    void buildJumpRow(const CityGrid &grid, int row);
+    int jumpHorizontal(int row, int col, int dCol, int target) const;
+    int jumpVertical(const CityGrid &grid, int row, int col, int dRow, int target) const;
+    bool runDial(const CityGrid &grid, int source, int target, bool reverse);
+    void loadBitboard(const CityGrid &grid);
+    void loadOpenWord(const std::vector<uint64_t> &blocked, int row, int word);
+    void spreadToWord(int word, uint64_t bits);
+
+public:
+    PathfindingContext();
+
+    // BFS over the passable cells of the grid.
+    // Writes the path (start and end included) into `path`, reusing its storage.
+    bool findPath(const CityGrid &grid,
+                  std::pair<int, int> start, std::pair<int, int> end,
+                  std::vector<std::pair<int, int>> &path);
+    // A* with the admissible Manhattan heuristic, same contract as findPath
+    bool findPathAStar(const CityGrid &grid,
+                       std::pair<int, int> start, std::pair<int, int> end,
+                       std::vector<std::pair<int, int>> &path);
+    // Jump Point Search, only jump points enter the open list. Horizontal
+    // jumps are read from per-row tables (8 bytes per cell), built by the
+    // first query and afterwards only for rows next to changed obstacles.
+    bool findPathJPS(const CityGrid &grid,
+                     std::pair<int, int> start, std::pair<int, int> end,
+                     std::vector<std::pair<int, int>> &path);
+    // Least-cost path where entering a cell costs traversalCost() of that cell.
+    // Same contract as findPath; the path cost is gCost of the end cell.
+    bool findPathWeighted(const CityGrid &grid,
+                          std::pair<int, int> start, std::pair<int, int> end,
+                          std::vector<std::pair<int, int>> &path);
+    // BFS where the frontier is a set of 64-bit words of a row-major bitset.
+    // Each level shifts every frontier word left, right, up and down and masks
+    // the result with the open and unvisited bits, so one word operation
+    // advances up to 64 cells. Each level is also OR-ed into two bitsets
+    // holding the level mod 3, which is all the walk back from the end needs,
+    // so no per-cell state is written. The path has the same length as
+    // findPath's (ties between equally short paths may go another way).
+    bool findPathBitboard(const CityGrid &grid,
+                          std::pair<int, int> start, std::pair<int, int> end,
+                          std::vector<std::pair<int, int>> &path);
+    // BFS run from both ends, one whole level at a time from the side with
+    // the smaller frontier, until the two searches meet. The path is as
+    // short as findPath's (ties may go another way). On open maps it visits
+    // about half as many cells.
+    bool findPathBidirectional(const CityGrid &grid,
+                               std::pair<int, int> start, std::pair<int, int> end,
+                               std::vector<std::pair<int, int>> &path);
+    // HPA* over the cluster graph; the graph is synced with the grid first,
+    // so only clusters whose obstacles changed are rebuilt. Same contract as
+    // findPath, but the path may be a few steps longer than the shortest one.
+    bool findPathHierarchical(const CityGrid &grid,
+                              std::pair<int, int> start, std::pair<int, int> end,
+                              std::vector<std::pair<int, int>> &path);
+    // Run the search selected by `engine`
+    bool findPath(PathEngine engine, const CityGrid &grid,
+                  std::pair<int, int> start, std::pair<int, int> end,
+                  std::vector<std::pair<int, int>> &path);
+
+    // Flood the grid outward from `source` with BFS. Afterwards
+    // fieldDistance() gives the road distance from any cell to the source.
+    void computeDistanceField(const CityGrid &grid, std::pair<int, int> source);
+    // Weighted version of computeDistanceField: fieldDistance() then gives
+    // the traversal cost of driving from any cell to the source
+    void computeCostField(const CityGrid &grid, std::pair<int, int> source);
+    // Steps (or cost) from `cell` to the last field's source, -1 if unreachable
+    int fieldDistance(std::pair<int, int> cell) const;
+
+    // Storage order of the per-cell arrays used by findPath (BFS) and
+    // computeDistanceField. ZOrder keeps vertical neighbors close in memory,
+    // which pays off once the arrays outgrow the L2 cache; the context then
+    // keeps a Z-ordered copy of the obstacle bits, updated only where the
+    // grid changed since its last query. Results do not depend on the order.
+    void setCellOrder(CellOrder order);
+    CellOrder getCellOrder() const { return cellOrder; }
+
+    // Costs used by the weighted searches, each clamped to at least 1
+    void setTraversalCosts(const TraversalCosts &costs);
+    const TraversalCosts &getTraversalCosts() const { return traversalCosts; }
+
+    // Number of cells taken off the frontier/open list by the last query
+    int lastExpandedCount() const;
+};
+
+#endif // PATHFINDING_H
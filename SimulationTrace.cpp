@@ -0,0 +1,486 @@
+#include "SimulationTrace.h"
+#include <algorithm> // For sort
+#include <cstring>   // For memcpy
+#include <cstdlib>   // For abs
+#include <fstream>   // For file operations
+#include <chrono>    // For timing replays
+
+const char TRACE_MAGIC[4] = {'S', 'R', 'T', 'R'};
+const uint64_t TRACE_VERSION = 1;
+
+// Event header byte: kind in bits 0-1, move in bits 2-4, time step in bits 5-6
+const int MOVE_STAYED = 4; // Driver is on the same cell (codes 0-3 are directions)
+const int MOVE_JUMPED = 5; // Any other cell, stored after the time step
+const int TIME_SAME = 0;
+const int TIME_WHOLE = 1;  // Varint number of seconds
+const int TIME_DOUBLE = 2;
+
+// Row and column change of each direction code, as in CompactPath
+static const int STEP_ROW[4] = {0, 0, 1, -1};
+static const int STEP_COL[4] = {1, -1, 0, 0};
+
+TraceRecorder::TraceRecorder(const SimulationWorld &simulationWorld, EventSimulator &eventSimulator,
+                             SimulationTrace &output)
+    : world(simulationWorld), simulator(eventSimulator), trace(output) {
+    trace = SimulationTrace();
+    trace.seed = world.placementSeed;
+    trace.rows = world.grid.getRows();
+    trace.cols = world.grid.getCols();
+    trace.pathEngine = world.pathEngine;
+    trace.cellOrder = world.cellOrder;
+    trace.traversalCosts = world.traversalCosts;
+    trace.userPos = world.userPos;
+    trace.driverPos = world.driverPos;
+    trace.driverFuel = world.driverFuel;
+    trace.obstacles = world.obstacles;
+    trace.trafficSignals = world.trafficSignals;
+    trace.fuelStations = world.fuelStations;
+    trace.congestionZones = world.congestionZones;
+    trace.endTime = simulator.now();
+}
+
+void TraceRecorder::attach() {
+    simulator.setDispatchCallback([this](int driverIndex, std::pair<int, int> target) {
+        recordDispatch(driverIndex, target);
+    });
+    simulator.setEventCallback([this](const SimEvent &event) { recordEvent(event); });
+}
+
+void TraceRecorder::recordDispatch(int driverIndex, std::pair<int, int> target) {
+    trace.dispatches.push_back({simulator.now(), simulator.eventsProcessed(), driverIndex, target});
+}
+
+void TraceRecorder::recordEvent(const SimEvent &event) {
+    trace.events.push_back({event.time, event.type, event.driverIndex, world.driverPos[event.driverIndex]});
+}
+
+void TraceRecorder::finish() {
+    trace.endTime = simulator.now();
+}
+
+// Function to append an unsigned LEB128 varint
+static void putVarint(std::vector<uint8_t> &bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+static void putDouble(std::vector<uint8_t> &bytes, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++) {
+        bytes.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+}
+
+static void putCell(std::vector<uint8_t> &bytes, std::pair<int, int> cell, int cols) {
+    putVarint(bytes, static_cast<uint64_t>(cell.first) * cols + cell.second);
+}
+
+// Sorted cell indices as the first index followed by the gaps
+static void putCellSet(std::vector<uint8_t> &bytes, const std::vector<std::pair<int, int>> &cells, int cols) {
+    std::vector<uint64_t> indices;
+    indices.reserve(cells.size());
+    for (const auto &cell : cells) {
+        indices.push_back(static_cast<uint64_t>(cell.first) * cols + cell.second);
+    }
+    std::sort(indices.begin(), indices.end());
+    putVarint(bytes, indices.size());
+    uint64_t previous = 0;
+    for (uint64_t index : indices) {
+        putVarint(bytes, index - previous);
+        previous = index;
+    }
+}
+
+void encodeTrace(const SimulationTrace &trace, std::vector<uint8_t> &bytes) {
+    bytes.assign(TRACE_MAGIC, TRACE_MAGIC + 4);
+    putVarint(bytes, TRACE_VERSION);
+    putVarint(bytes, trace.seed);
+    putVarint(bytes, trace.rows);
+    putVarint(bytes, trace.cols);
+    putVarint(bytes, static_cast<uint64_t>(trace.pathEngine));
+    putVarint(bytes, static_cast<uint64_t>(trace.cellOrder));
+    putVarint(bytes, trace.traversalCosts.road);
+    putVarint(bytes, trace.traversalCosts.trafficSignal);
+    putVarint(bytes, trace.traversalCosts.congestionZone);
+
+    int cols = trace.cols;
+    putCell(bytes, trace.userPos, cols);
+    putVarint(bytes, trace.driverPos.size());
+    for (size_t i = 0; i < trace.driverPos.size(); i++) {
+        putCell(bytes, trace.driverPos[i], cols);
+        putVarint(bytes, static_cast<uint32_t>(i < trace.driverFuel.size() ? trace.driverFuel[i] : 0));
+    }
+    putCellSet(bytes, trace.obstacles, cols);
+    putCellSet(bytes, trace.trafficSignals, cols);
+    putCellSet(bytes, trace.fuelStations, cols);
+    putCellSet(bytes, trace.congestionZones, cols);
+
+    putVarint(bytes, trace.dispatches.size());
+    for (const TraceDispatch &dispatch : trace.dispatches) {
+        putDouble(bytes, dispatch.time);
+        putVarint(bytes, dispatch.eventIndex);
+        putVarint(bytes, dispatch.driverIndex);
+        putCell(bytes, dispatch.target, cols);
+    }
+    putDouble(bytes, trace.endTime);
+
+    putVarint(bytes, trace.events.size());
+    std::vector<std::pair<int, int>> cells = trace.driverPos;
+    double clock = 0.0;
+    for (const TraceEvent &event : trace.events) {
+        std::pair<int, int> &from = cells[event.driverIndex];
+        int move = MOVE_JUMPED;
+        if (event.cell == from) {
+            move = MOVE_STAYED;
+        }
+        for (int d = 0; d < 4 && move == MOVE_JUMPED; d++) {
+            if (event.cell.first - from.first == STEP_ROW[d] && event.cell.second - from.second == STEP_COL[d]) {
+                move = d;
+            }
+        }
+        double step = event.time - clock;
+        int timeKind = TIME_DOUBLE;
+        if (step == 0.0) {
+            timeKind = TIME_SAME;
+        } else if (step > 0.0 && step < 4294967296.0 && step == static_cast<double>(static_cast<uint64_t>(step))) {
+            timeKind = TIME_WHOLE;
+        }
+
+        bytes.push_back(static_cast<uint8_t>(static_cast<int>(event.type) | (move << 2) | (timeKind << 5)));
+        putVarint(bytes, event.driverIndex);
+        if (timeKind == TIME_WHOLE) {
+            putVarint(bytes, static_cast<uint64_t>(step));
+        } else if (timeKind == TIME_DOUBLE) {
+            putDouble(bytes, event.time);
+        }
+        if (move == MOVE_JUMPED) {
+            putCell(bytes, event.cell, cols);
+        }
+        from = event.cell;
+        clock = event.time;
+    }
+}
+
+// Bounds-checked reader over an encoded trace; ok turns false on the first bad read
+struct TraceReader {
+    const std::vector<uint8_t> &bytes;
+    size_t at;
+    bool ok;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (at >= bytes.size()) {
+                break;
+            }
+            uint8_t byte = bytes[at++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    // Varint that must fit below `limit`
+    int bounded(uint64_t limit) {
+        uint64_t value = varint();
+        if (value >= limit) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<int>(value);
+    }
+
+    double real() {
+        if (bytes.size() - at < 8) {
+            ok = false;
+            at = bytes.size();
+            return 0.0;
+        }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; i++) {
+            bits |= static_cast<uint64_t>(bytes[at++]) << (8 * i);
+        }
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::pair<int, int> cell(int rows, int cols) {
+        int index = bounded(static_cast<uint64_t>(rows) * cols);
+        return {index / cols, index % cols};
+    }
+
+    void cellSet(std::vector<std::pair<int, int>> &cells, int rows, int cols) {
+        uint64_t cellCount = static_cast<uint64_t>(rows) * cols;
+        uint64_t count = varint();
+        if (count > cellCount) {
+            ok = false;
+            return;
+        }
+        uint64_t index = 0;
+        for (uint64_t i = 0; i < count && ok; i++) {
+            index += varint();
+            if (index >= cellCount) {
+                ok = false;
+                return;
+            }
+            cells.push_back({static_cast<int>(index / cols), static_cast<int>(index % cols)});
+        }
+    }
+};
+
+bool decodeTrace(const std::vector<uint8_t> &bytes, SimulationTrace &trace) {
+    trace = SimulationTrace();
+    if (bytes.size() < 4 || !std::equal(TRACE_MAGIC, TRACE_MAGIC + 4, bytes.begin())) {
+        return false;
+    }
+    TraceReader in{bytes, 4, true};
+    if (in.varint() != TRACE_VERSION) {
+        return false;
+    }
+    trace.seed = in.varint();
+    trace.rows = in.bounded(1u << 31);
+    trace.cols = in.bounded(1u << 31);
+    if (!in.ok || trace.rows <= 0 || trace.cols <= 0 ||
+        static_cast<uint64_t>(trace.rows) * trace.cols >= (1u << 31)) {
+        return false;
+    }
+    trace.pathEngine = static_cast<PathEngine>(in.bounded(static_cast<int>(PathEngine::Bidirectional) + 1));
+    trace.cellOrder = static_cast<CellOrder>(in.bounded(static_cast<int>(CellOrder::ZOrder) + 1));
+    trace.traversalCosts.road = in.bounded(1u << 31);
+    trace.traversalCosts.trafficSignal = in.bounded(1u << 31);
+    trace.traversalCosts.congestionZone = in.bounded(1u << 31);
+
+    int rows = trace.rows, cols = trace.cols;
+    trace.userPos = in.cell(rows, cols);
+    uint64_t driverCount = in.varint();
+    if (driverCount > static_cast<uint64_t>(rows) * cols) {
+        return false;
+    }
+    for (uint64_t i = 0; i < driverCount && in.ok; i++) {
+        trace.driverPos.push_back(in.cell(rows, cols));
+        trace.driverFuel.push_back(static_cast<int>(static_cast<uint32_t>(in.varint())));
+    }
+    in.cellSet(trace.obstacles, rows, cols);
+    in.cellSet(trace.trafficSignals, rows, cols);
+    in.cellSet(trace.fuelStations, rows, cols);
+    in.cellSet(trace.congestionZones, rows, cols);
+
+    uint64_t dispatchCount = in.varint();
+    for (uint64_t i = 0; i < dispatchCount && in.ok; i++) {
+        TraceDispatch dispatch;
+        dispatch.time = in.real();
+        dispatch.eventIndex = static_cast<long long>(in.varint());
+        dispatch.driverIndex = in.bounded(driverCount);
+        dispatch.target = in.cell(rows, cols);
+        trace.dispatches.push_back(dispatch);
+    }
+    trace.endTime = in.real();
+
+    uint64_t eventCount = in.varint();
+    std::vector<std::pair<int, int>> cells = trace.driverPos;
+    double clock = 0.0;
+    for (uint64_t i = 0; i < eventCount && in.ok; i++) {
+        if (in.at >= bytes.size()) {
+            return false; // Every event takes at least its header byte
+        }
+        uint8_t header = bytes[in.at++];
+        int type = header & 3;
+        int move = (header >> 2) & 7;
+        int timeKind = (header >> 5) & 3;
+        if (type > static_cast<int>(SimEventType::DriverRefuel) || move > MOVE_JUMPED ||
+            timeKind > TIME_DOUBLE || (header & 0x80)) {
+            return false;
+        }
+        TraceEvent event;
+        event.type = static_cast<SimEventType>(type);
+        event.driverIndex = in.bounded(driverCount);
+        if (!in.ok) {
+            return false;
+        }
+        if (timeKind == TIME_WHOLE) {
+            clock += static_cast<double>(in.varint());
+        } else if (timeKind == TIME_DOUBLE) {
+            clock = in.real();
+        }
+        event.time = clock;
+        std::pair<int, int> &at = cells[event.driverIndex];
+        if (move == MOVE_JUMPED) {
+            at = in.cell(rows, cols);
+        } else if (move != MOVE_STAYED) {
+            at = {at.first + STEP_ROW[move], at.second + STEP_COL[move]};
+            if (at.first < 0 || at.first >= rows || at.second < 0 || at.second >= cols) {
+                return false;
+            }
+        }
+        event.cell = at;
+        trace.events.push_back(event);
+    }
+    return in.ok && in.at == bytes.size();
+}
+
+bool saveTrace(const SimulationTrace &trace, const std::string &filename) {
+    std::vector<uint8_t> bytes;
+    encodeTrace(trace, bytes);
+    std::ofstream outFile(filename, std::ios::binary);
+    outFile.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    return static_cast<bool>(outFile);
+}
+
+bool loadTrace(const std::string &filename, SimulationTrace &trace) {
+    std::ifstream inFile(filename, std::ios::binary);
+    if (!inFile) {
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+    return decodeTrace(bytes, trace);
+}
+
+void buildTraceWorld(const SimulationTrace &trace, SimulationWorld &world) {
+    initGrid(world, trace.rows, trace.cols);
+    setPlacementSeed(world, trace.seed);
+    world.pathEngine = trace.pathEngine;
+    world.cellOrder = trace.cellOrder;
+    world.traversalCosts = trace.traversalCosts;
+    world.userPos = trace.userPos;
+    world.driverPos = trace.driverPos;
+    world.driverFuel = trace.driverFuel;
+    world.obstacles = trace.obstacles;
+    world.trafficSignals = trace.trafficSignals;
+    world.fuelStations = trace.fuelStations;
+    world.congestionZones = trace.congestionZones;
+    world.driverNames.clear();
+    world.carModels.clear();
+    for (size_t i = 0; i < world.driverPos.size(); i++) {
+        world.driverNames.push_back("Driver" + std::to_string(i + 1));
+        world.carModels.push_back("-");
+    }
+    updateGrid(world);
+}
+
+// First index where the replayed events leave the recorded ones, -1 if none
+static long long firstDifference(const std::vector<TraceEvent> &recorded, const std::vector<TraceEvent> &replayed) {
+    size_t common = std::min(recorded.size(), replayed.size());
+    for (size_t i = 0; i < common; i++) {
+        if (!(recorded[i] == replayed[i])) {
+            return static_cast<long long>(i);
+        }
+    }
+    return recorded.size() == replayed.size() ? -1 : static_cast<long long>(common);
+}
+
+// Add up the work a run of events did, starting from the drivers' cells
+static void tallyEvents(std::vector<std::pair<int, int>> cells, const std::vector<TraceEvent> &events,
+                        ReplayResult &result) {
+    for (const TraceEvent &event : events) {
+        if (event.type == SimEventType::DriverMove && event.cell != cells[event.driverIndex]) {
+            cells[event.driverIndex] = event.cell;
+            result.moves++;
+        } else if (event.type == SimEventType::DriverArrival) {
+            result.arrivals++;
+        } else if (event.type == SimEventType::DriverRefuel) {
+            result.refuels++;
+        }
+    }
+}
+
+// Function to run the recorded rides again and compare the events
+ReplayResult replayTrace(const SimulationTrace &trace, SimulationWorld &world, PathEngine engine) {
+    ReplayResult result;
+    auto startTime = std::chrono::steady_clock::now();
+    buildTraceWorld(trace, world);
+    world.pathEngine = engine;
+
+    EventSimulator simulator(world);
+    SimulationTrace replayed;
+    TraceRecorder recorder(world, simulator, replayed);
+    recorder.attach();
+
+    const std::vector<TraceDispatch> &dispatches = trace.dispatches;
+    size_t next = 0;
+    auto dispatchNext = [&]() {
+        const TraceDispatch &dispatch = dispatches[next++];
+        simulator.dispatchRide(dispatch.driverIndex, dispatch.target);
+    };
+    bool inOrder = engine == trace.pathEngine;
+    if (inOrder) {
+        // Rides dispatched from a callback (after an arrival, say) go out
+        // right after the event they were dispatched in
+        simulator.setEventCallback([&](const SimEvent &event) {
+            recorder.recordEvent(event);
+            while (next < dispatches.size() && dispatches[next].eventIndex == simulator.eventsProcessed() &&
+                   dispatches[next].time == simulator.now()) {
+                dispatchNext();
+            }
+        });
+    }
+    while (next < dispatches.size()) {
+        size_t current = next;
+        const TraceDispatch &dispatch = dispatches[current];
+        if (!inOrder || simulator.eventsProcessed() < dispatch.eventIndex) {
+            simulator.run(dispatch.time); // In order, the event callback may dispatch it
+        }
+        if (next == current) {
+            if (simulator.now() < dispatch.time) {
+                simulator.run(dispatch.time); // Only moves the clock, nothing else is due
+            }
+            dispatchNext();
+        }
+    }
+    simulator.run();
+    recorder.finish();
+
+    result.events = static_cast<long long>(replayed.events.size());
+    tallyEvents(trace.driverPos, replayed.events, result);
+    result.endTime = simulator.now();
+    result.firstMismatch = firstDifference(trace.events, replayed.events);
+    result.matches = result.firstMismatch < 0 && replayed.dispatches.size() == dispatches.size();
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+ReplayResult replayTrace(const SimulationTrace &trace, SimulationWorld &world) {
+    return replayTrace(trace, world, trace.pathEngine);
+}
+
+// Function to apply the recorded events without searching for routes
+ReplayResult fastForwardTrace(const SimulationTrace &trace, SimulationWorld &world, double untilTime) {
+    ReplayResult result;
+    auto startTime = std::chrono::steady_clock::now();
+    buildTraceWorld(trace, world);
+
+    for (const TraceEvent &event : trace.events) {
+        if (untilTime >= 0.0 && event.time > untilTime) {
+            break;
+        }
+        std::pair<int, int> &at = world.driverPos[event.driverIndex];
+        if (event.type == SimEventType::DriverMove && event.cell != at) {
+            int distance = std::abs(event.cell.first - at.first) + std::abs(event.cell.second - at.second);
+            if ((distance != 1 || !world.grid.isPassable(event.cell.first, event.cell.second)) && result.firstMismatch < 0) {
+                result.firstMismatch = result.events;
+            }
+            at = event.cell;
+            world.driverFuel[event.driverIndex]--;
+            result.moves++;
+        } else if (event.type == SimEventType::DriverArrival) {
+            result.arrivals++;
+        } else if (event.type == SimEventType::DriverRefuel) {
+            world.driverFuel[event.driverIndex] = FULL_TANK;
+            result.refuels++;
+        }
+        result.endTime = event.time;
+        result.events++;
+    }
+    updateGrid(world);
+
+    result.matches = result.firstMismatch < 0;
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
@@ -0,0 +1,118 @@
+#ifndef SIMULATION_TRACE_H
+#define SIMULATION_TRACE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "Location_Tracking.h"
+#include "EventSimulation.h"
+
+// Ride handed to the simulator during a recorded run
+struct TraceDispatch {
+    double time;
+    long long eventIndex; // Events processed before the dispatch (the current one included)
+    int driverIndex;
+    std::pair<int, int> target;
+};
+
+// Event processed during a recorded run
+struct TraceEvent {
+    double time;
+    SimEventType type;
+    int driverIndex;
+    std::pair<int, int> cell; // Driver's cell after the event
+
+    bool operator==(const TraceEvent &other) const {
+        return time == other.time && type == other.type && driverIndex == other.driverIndex && cell == other.cell;
+    }
+};
+
+// Everything needed to run a simulation again: the seed, the world as it
+// was when the first ride was dispatched, the rides and the events they caused
+struct SimulationTrace {
+    uint64_t seed = 0;
+    int rows = 0;
+    int cols = 0;
+    PathEngine pathEngine = PathEngine::BFS;
+    CellOrder cellOrder = CellOrder::RowMajor;
+    TraversalCosts traversalCosts;
+    std::pair<int, int> userPos;
+    std::vector<std::pair<int, int>> driverPos;
+    std::vector<int> driverFuel;
+    std::vector<std::pair<int, int>> obstacles;
+    std::vector<std::pair<int, int>> trafficSignals;
+    std::vector<std::pair<int, int>> fuelStations;
+    std::vector<std::pair<int, int>> congestionZones;
+    std::vector<TraceDispatch> dispatches;
+    std::vector<TraceEvent> events;
+    double endTime = 0.0; // Clock when recording stopped
+};
+
+// Records a run of an EventSimulator into a SimulationTrace.
+// The simulator's world is captured on construction, so create the recorder
+// after the layout is placed and before the first ride is dispatched.
+class TraceRecorder {
+private:
+    const SimulationWorld &world;
+    EventSimulator &simulator;
+    SimulationTrace &trace;
+
+public:
+    TraceRecorder(const SimulationWorld &simulationWorld, EventSimulator &eventSimulator,
+                  SimulationTrace &output);
+
+    // Route the simulator's event and dispatch callbacks to the recorder
+    void attach();
+    // For callers that need the callbacks themselves
+    void recordDispatch(int driverIndex, std::pair<int, int> target);
+    void recordEvent(const SimEvent &event);
+    // Stamp the end time, call once the run is over
+    void finish();
+};
+
+// Binary trace format, little-endian, integers as LEB128 varints:
+//   "SRTR", version, seed, rows, cols, engine, cell order, the three costs,
+//   user cell, drivers (cell and fuel each), the obstacle, signal, station
+//   and zone cells (sorted, as gaps between cell indices), dispatches
+//   (time, event index, driver, target), end time, event count, events.
+// Cells are row * cols + col; times are 8-byte doubles unless noted.
+// An event takes one header byte (kind, move and time encoding), the driver
+// and, when the clock moved, the time step: a varint when it is a whole
+// number of seconds, else a double. A move is stored as its direction code
+// (right, left, down, up) or "stayed", so a step costs 2-3 bytes.
+void encodeTrace(const SimulationTrace &trace, std::vector<uint8_t> &bytes);
+bool decodeTrace(const std::vector<uint8_t> &bytes, SimulationTrace &trace); // False on malformed input
+bool saveTrace(const SimulationTrace &trace, const std::string &filename);
+bool loadTrace(const std::string &filename, SimulationTrace &trace);
+
+// Outcome of replaying a trace
+struct ReplayResult {
+    long long events = 0;          // Events processed or applied
+    long long moves = 0;           // Cells driven, summed over the drivers
+    int arrivals = 0;              // Rides that reached their target
+    int refuels = 0;
+    double endTime = 0.0;          // Clock after the last event
+    bool matches = false;          // Same events as the trace, in the same order
+    long long firstMismatch = -1;  // Index of the first differing event, -1 if none
+    double wallSeconds = 0.0;      // Real time the replay took
+};
+
+// Rebuild the recorded starting world in `world`
+void buildTraceWorld(const SimulationTrace &trace, SimulationWorld &world);
+// Run the recorded rides again without rendering, routed by `engine`.
+// Rides are dispatched at their place in the event order when the engine is
+// the recorded one, and at their recorded time (after the events due by
+// then) otherwise. The new events are compared with the recorded ones;
+// under another engine the moves, arrivals and end time show how the same
+// workload came out (compare with fastForwardTrace of the trace).
+ReplayResult replayTrace(const SimulationTrace &trace, SimulationWorld &world, PathEngine engine);
+ReplayResult replayTrace(const SimulationTrace &trace, SimulationWorld &world); // Recorded engine
+// Apply the recorded moves and refuels up to `untilTime` (-1 for all)
+// without any route search; leaves `world` as the run had it then.
+// A move that does not end on the driver's cell or a passable neighbor
+// counts as a mismatch.
+ReplayResult fastForwardTrace(const SimulationTrace &trace, SimulationWorld &world, double untilTime = -1.0);
+
+#endif // SIMULATION_TRACE_H
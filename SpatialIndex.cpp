@@ -0,0 +1,154 @@
+#include "SpatialIndex.h"
+#include <algorithm> // For push_heap, pop_heap, sort_heap and max
+#include <cstdlib>   // For abs
+
+SpatialIndex::SpatialIndex(int gridRows, int gridCols, int cellsPerBucket)
+    : rows(0), cols(0), bucketSize(std::max(1, cellsPerBucket)), bucketRows(0), bucketCols(0), entryCount(0) {
+    reset(gridRows, gridCols);
+}
+
+void SpatialIndex::reset(int gridRows, int gridCols) {
+    rows = gridRows;
+    cols = gridCols;
+    bucketRows = (rows + bucketSize - 1) / bucketSize;
+    bucketCols = (cols + bucketSize - 1) / bucketSize;
+    buckets.assign(static_cast<size_t>(bucketRows) * bucketCols, std::vector<int>());
+    positions.clear();
+    bucketOf.clear();
+    slotOf.clear();
+    entryCount = 0;
+}
+
+int SpatialIndex::bucketFor(std::pair<int, int> pos) const {
+    return (pos.first / bucketSize) * bucketCols + pos.second / bucketSize;
+}
+
+// Remove an id from its bucket by moving the bucket's last id into its slot
+void SpatialIndex::detach(int id) {
+    std::vector<int> &bucket = buckets[bucketOf[id]];
+    int moved = bucket.back();
+    bucket[slotOf[id]] = moved;
+    slotOf[moved] = slotOf[id];
+    bucket.pop_back();
+    bucketOf[id] = -1;
+}
+
+void SpatialIndex::insert(int id, std::pair<int, int> pos) {
+    if (id >= static_cast<int>(positions.size())) {
+        positions.resize(id + 1);
+        bucketOf.resize(id + 1, -1);
+        slotOf.resize(id + 1, -1);
+    }
+    if (bucketOf[id] >= 0) {
+        update(id, pos);
+        return;
+    }
+    int bucket = bucketFor(pos);
+    positions[id] = pos;
+    bucketOf[id] = bucket;
+    slotOf[id] = static_cast<int>(buckets[bucket].size());
+    buckets[bucket].push_back(id);
+    entryCount++;
+}
+
+// Moving within a bucket only rewrites the position
+void SpatialIndex::update(int id, std::pair<int, int> pos) {
+    if (!contains(id)) {
+        insert(id, pos);
+        return;
+    }
+    int bucket = bucketFor(pos);
+    positions[id] = pos;
+    if (bucket == bucketOf[id]) {
+        return;
+    }
+    detach(id);
+    bucketOf[id] = bucket;
+    slotOf[id] = static_cast<int>(buckets[bucket].size());
+    buckets[bucket].push_back(id);
+}
+
+void SpatialIndex::remove(int id) {
+    if (!contains(id)) {
+        return;
+    }
+    detach(id);
+    entryCount--;
+}
+
+void SpatialIndex::truncate(int count) {
+    for (int id = static_cast<int>(bucketOf.size()) - 1; id >= count && id >= 0; id--) {
+        remove(id);
+    }
+    if (count >= 0 && count < static_cast<int>(bucketOf.size())) {
+        positions.resize(count);
+        bucketOf.resize(count);
+        slotOf.resize(count);
+    }
+}
+
+bool SpatialIndex::contains(int id) const {
+    return id >= 0 && id < static_cast<int>(bucketOf.size()) && bucketOf[id] >= 0;
+}
+
+int SpatialIndex::size() const {
+    return entryCount;
+}
+
+int SpatialIndex::nearest(std::pair<int, int> query) const {
+    std::vector<int> best = kNearest(query, 1);
+    return best.empty() ? -1 : best[0];
+}
+
+std::vector<int> SpatialIndex::kNearest(std::pair<int, int> query, int k) const {
+    std::vector<std::pair<int, int>> heap; // (distance, id), worst candidate on top
+    if (k <= 0 || entryCount == 0) {
+        return {};
+    }
+
+    int queryBucketRow = query.first / bucketSize;
+    int queryBucketCol = query.second / bucketSize;
+    int maxRing = std::max(std::max(queryBucketRow, bucketRows - 1 - queryBucketRow),
+                           std::max(queryBucketCol, bucketCols - 1 - queryBucketCol));
+
+    for (int ring = 0; ring <= maxRing; ring++) {
+        // Every cell in this ring is at least this far away in one coordinate
+        int lowerBound = ring == 0 ? 0 : (ring - 1) * bucketSize + 1;
+        if (static_cast<int>(heap.size()) == k && heap.front().first < lowerBound) {
+            break;
+        }
+
+        for (int bucketRow = queryBucketRow - ring; bucketRow <= queryBucketRow + ring; bucketRow++) {
+            if (bucketRow < 0 || bucketRow >= bucketRows) {
+                continue;
+            }
+            // Interior rows of the ring only touch its left and right edges
+            bool edgeRow = bucketRow == queryBucketRow - ring || bucketRow == queryBucketRow + ring;
+            int step = edgeRow || ring == 0 ? 1 : 2 * ring;
+            for (int bucketCol = queryBucketCol - ring; bucketCol <= queryBucketCol + ring; bucketCol += step) {
+                if (bucketCol < 0 || bucketCol >= bucketCols) {
+                    continue;
+                }
+                for (int id : buckets[bucketRow * bucketCols + bucketCol]) {
+                    std::pair<int, int> pos = positions[id];
+                    std::pair<int, int> candidate = {std::abs(pos.first - query.first) + std::abs(pos.second - query.second), id};
+                    if (static_cast<int>(heap.size()) < k) {
+                        heap.push_back(candidate);
+                        std::push_heap(heap.begin(), heap.end());
+                    } else if (candidate < heap.front()) {
+                        std::pop_heap(heap.begin(), heap.end());
+                        heap.back() = candidate;
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    std::vector<int> ids;
+    for (auto &entry : heap) {
+        ids.push_back(entry.second);
+    }
+    return ids;
+}
@@ -0,0 +1,48 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <vector>
+#include <utility>
+
+// Uniform bucket grid over the map for Manhattan-distance lookups.
+// Each entry has an integer id (its index in the caller's vector) and lives
+// in the bucket of bucketSize x bucketSize cells that contains it. Queries
+// visit buckets in rings around the query cell and stop once no unseen
+// bucket can hold a closer entry. Ties go to the lowest id, which is the
+// same answer a linear scan with a strict '<' gives.
+class SpatialIndex {
+private:
+    int rows;
+    int cols;
+    int bucketSize;
+    int bucketRows;
+    int bucketCols;
+    std::vector<std::vector<int>> buckets;    // Ids per bucket
+    std::vector<std::pair<int, int>> positions; // Indexed by id
+    std::vector<int> bucketOf;                 // Bucket holding the id, -1 if absent
+    std::vector<int> slotOf;                   // Position of the id inside its bucket
+    int entryCount;
+
+    int bucketFor(std::pair<int, int> pos) const;
+    void detach(int id);
+
+public:
+    SpatialIndex(int gridRows = 0, int gridCols = 0, int cellsPerBucket = 16);
+
+    void reset(int gridRows, int gridCols); // Drops all entries
+    void insert(int id, std::pair<int, int> pos);
+    void update(int id, std::pair<int, int> pos); // Inserts if the id is new
+    void remove(int id);
+    void truncate(int count); // Removes every id >= count
+    bool contains(int id) const;
+    int size() const;
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+
+    // Closest id to `query`, -1 if the index is empty
+    int nearest(std::pair<int, int> query) const;
+    // Up to k closest ids ordered by (distance, id)
+    std::vector<int> kNearest(std::pair<int, int> query, int k) const;
+};
+
+#endif // SPATIAL_INDEX_H
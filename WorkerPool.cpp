@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+#include <algorithm> // For min
+
+WorkerPool::WorkerPool(unsigned threadCount)
+    : job(nullptr), jobSize(0), jobGrain(1), nextChunk(0), pendingWorkers(0), generation(0), shuttingDown(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 1; i < threadCount; i++) { // The caller is the first thread
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        shuttingDown = true;
+    }
+    workReady.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+// Take chunks until the range is exhausted
+void WorkerPool::runChunks() {
+    while (true) {
+        size_t begin = nextChunk.fetch_add(jobGrain);
+        if (begin >= jobSize) {
+            break;
+        }
+        (*job)(begin, std::min(begin + jobGrain, jobSize));
+    }
+}
+
+void WorkerPool::workerLoop() {
+    long long seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        workReady.wait(lock, [&]() { return shuttingDown || generation != seenGeneration; });
+        if (shuttingDown) {
+            return;
+        }
+        seenGeneration = generation;
+        lock.unlock();
+        runChunks();
+        lock.lock();
+        if (--pendingWorkers == 0) {
+            workDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    if (workers.empty() || count <= grain) {
+        body(0, count); // Not worth waking anyone
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        job = &body;
+        jobSize = count;
+        jobGrain = grain;
+        nextChunk.store(0);
+        pendingWorkers = workers.size();
+        generation++;
+    }
+    workReady.notify_all();
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mtx);
+    workDone.wait(lock, [&]() { return pendingWorkers == 0; });
+    job = nullptr;
+}
+
+unsigned WorkerPool::threadCount() const {
+    return static_cast<unsigned>(workers.size()) + 1;
+}
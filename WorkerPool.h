@@ -0,0 +1,44 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+
+// Fixed set of worker threads for data-parallel loops.
+// parallelFor splits [0, count) into chunks of `grain` items. The calling
+// thread and the workers take chunks from a shared atomic counter.
+// parallelFor returns once every chunk has run. The threads stay alive
+// between calls, so a loop costs no thread creation.
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+
+    const std::function<void(size_t, size_t)> *job;
+    size_t jobSize;
+    size_t jobGrain;
+    std::atomic<size_t> nextChunk;
+    size_t pendingWorkers;
+    long long generation;
+    bool shuttingDown;
+
+    void workerLoop();
+    void runChunks();
+
+public:
+    // threadCount 0 uses all hardware threads (the caller counts as one)
+    explicit WorkerPool(unsigned threadCount = 0);
+    ~WorkerPool();
+
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body);
+    unsigned threadCount() const; // Including the calling thread
+};
+
+#endif // WORKER_POOL_H
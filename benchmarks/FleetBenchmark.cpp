@@ -0,0 +1,102 @@
+// Standalone check and timing driver for FleetEngine.
+// Not part of the app build; from the repository root, compile
+//   benchmarks/FleetBenchmark.cpp FleetEngine.cpp Pathfinding.cpp CityGrid.cpp
+//   CellLayout.cpp HierarchicalGraph.cpp CompactPath.cpp WorkerPool.cpp FastRandom.cpp
+// with g++ -std=c++17 -O2 -pthread -I. into fleetbench, then run
+//   ./fleetbench [drivers] [threads]
+// Defaults are 20000 drivers and one thread per core. The fleet is run once
+// on one thread and once on `threads`; the final positions, fuel and states
+// must match, and the program exits with 1 if they do not.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>    // For steady_clock
+#include <algorithm> // For min and max
+#include <cstdlib>   // For atoi
+#include <thread>    // For hardware_concurrency
+#include "FleetEngine.h"
+#include "FastRandom.h"
+
+const int SIDE = 512;        // Map is SIDE x SIDE
+const int TARGET_RANGE = 64; // Targets lie within this many rows and columns of the start
+const int LOW_FUEL = 30;     // Every seventh driver starts with this much fuel
+
+// Result of one fleet run
+struct FleetRun {
+    double planSeconds = 0.0; // First tick, where every driver plans its route
+    long long ticks = 0;
+    double ticksPerSecond = 0.0;
+    int counts[6] = {0};      // Drivers per FleetStatus
+    uint64_t hash = 1469598103934665603ULL; // FNV-1a over positions, fuel and states
+};
+
+// Function to build the map and run the same seeded fleet on `threads` threads
+static FleetRun runFleet(int drivers, unsigned threads) {
+    CityGrid grid(SIDE, SIDE);
+    FastRandom random(1);
+    for (int i = 0; i < SIDE * SIDE / 20; i++) {
+        grid.setBlocked(static_cast<int>(random.nextBelow(SIDE)), static_cast<int>(random.nextBelow(SIDE)), true);
+    }
+
+    FleetEngine fleet(grid, threads);
+    for (int i = 0; i < drivers; i++) {
+        int row, col;
+        do {
+            row = static_cast<int>(random.nextBelow(SIDE));
+            col = static_cast<int>(random.nextBelow(SIDE));
+        } while (!grid.isPassable(row, col));
+        fleet.addDriver({row, col}, i % 7 == 0 ? LOW_FUEL : 1000000);
+        int targetRow = std::min(SIDE - 1, std::max(0, row + static_cast<int>(random.nextBelow(2 * TARGET_RANGE + 1)) - TARGET_RANGE));
+        int targetCol = std::min(SIDE - 1, std::max(0, col + static_cast<int>(random.nextBelow(2 * TARGET_RANGE + 1)) - TARGET_RANGE));
+        if (!grid.isPassable(targetRow, targetCol)) {
+            targetRow = row;
+            targetCol = col;
+        }
+        fleet.assignTarget(i, {targetRow, targetCol});
+    }
+
+    FleetRun result;
+    auto start = std::chrono::steady_clock::now();
+    fleet.tick();
+    result.planSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.ticks = 1 + fleet.run(SIDE * SIDE);
+    result.ticksPerSecond = fleet.ticksPerSecond();
+    for (int i = 0; i < drivers; i++) {
+        result.counts[static_cast<int>(fleet.statusOf(i))]++;
+        std::pair<int, int> pos = fleet.position(i);
+        uint64_t values[3] = {static_cast<uint64_t>(pos.first * SIDE + pos.second),
+                              static_cast<uint64_t>(fleet.fuelLevel(i)),
+                              static_cast<uint64_t>(fleet.statusOf(i))};
+        for (uint64_t value : values) {
+            result.hash = (result.hash ^ value) * 1099511628211ULL;
+        }
+    }
+    return result;
+}
+
+// Function to print one run
+static void report(unsigned threads, const FleetRun &run) {
+    std::cout << "  " << std::setw(2) << threads << " thread(s): plan tick " << std::fixed << std::setprecision(3)
+              << run.planSeconds << " s, " << run.ticks << " ticks, " << std::setprecision(0) << run.ticksPerSecond
+              << " ticks/s, arrived " << run.counts[static_cast<int>(FleetStatus::Arrived)]
+              << ", no path " << run.counts[static_cast<int>(FleetStatus::NoPath)]
+              << ", out of fuel " << run.counts[static_cast<int>(FleetStatus::OutOfFuel)] << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    int drivers = argc > 1 ? std::atoi(argv[1]) : 20000;
+    unsigned threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << drivers << " drivers on a " << SIDE << "^2 map with 5% obstacles\n";
+    FleetRun single = runFleet(drivers, 1);
+    report(1, single);
+    FleetRun parallel = runFleet(drivers, threads);
+    report(threads, parallel);
+
+    if (single.hash != parallel.hash) {
+        std::cout << "Final fleet state differs between 1 and " << threads << " threads\n";
+        return 1;
+    }
+    std::cout << "Final fleet state matches\n";
+    return 0;
+}
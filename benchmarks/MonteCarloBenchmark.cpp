@@ -0,0 +1,50 @@
+// Standalone check and timing driver for the Monte Carlo batches.
+// Not part of the app build; from the repository root, compile
+//   benchmarks/MonteCarloBenchmark.cpp and every .cpp of the root except Main.cpp
+// with g++ -std=c++17 -O2 -pthread -I. into montecarlobench, then run
+//   ./montecarlobench [scenarios] [threads] [road closures]
+// Defaults are 2000 scenarios, one thread per core and no closures. The
+// batch is run once on one thread and once on `threads`; every scenario's
+// pickup time must match, and the program exits with 1 if one does not.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm> // For max
+#include <cstdlib>   // For atoi
+#include <thread>    // For hardware_concurrency
+#include "MonteCarlo.h"
+
+// Function to print the statistics of one batch
+static void report(unsigned threads, const BatchStatistics &stats) {
+    std::cout << "  " << std::setw(2) << threads << " thread(s): " << std::fixed << std::setprecision(3)
+              << stats.wallSeconds << " s, served " << stats.served << ", unserved " << stats.unserved << "\n"
+              << "    pickup time mean " << stats.meanPickupTime << " (sd " << stats.stdDevPickupTime
+              << "), min " << stats.minPickupTime << ", median " << stats.medianPickupTime << ", p90 "
+              << stats.p90PickupTime << ", p99 " << stats.p99PickupTime << ", max " << stats.maxPickupTime << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    int scenarios = argc > 1 ? std::atoi(argv[1]) : 2000;
+    unsigned threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+    ScenarioConfig config;
+    config.rows = 60;
+    config.cols = 60;
+    config.obstacles = 1400;
+    config.drivers = 8;
+    config.roadClosures = argc > 3 ? std::atoi(argv[3]) : 0;
+
+    std::cout << scenarios << " scenarios on a " << config.rows << "x" << config.cols << " map, "
+              << config.obstacles << " obstacles, " << config.drivers << " drivers, "
+              << config.roadClosures << " road closures\n";
+    std::vector<double> singleTimes, parallelTimes;
+    report(1, runMonteCarloBatch(config, scenarios, 1, 1, &singleTimes));
+    report(threads, runMonteCarloBatch(config, scenarios, 1, threads, &parallelTimes));
+
+    if (singleTimes != parallelTimes) {
+        std::cout << "Pickup times differ between 1 and " << threads << " threads\n";
+        return 1;
+    }
+    std::cout << "Pickup times match\n";
+    return 0;
+}
@@ -0,0 +1,149 @@
+// Standalone timing driver for the grid searches.
+// Not part of the app build; from the repository root, compile
+//   benchmarks/SearchBenchmark.cpp Pathfinding.cpp CityGrid.cpp CellLayout.cpp
+//   HierarchicalGraph.cpp FastRandom.cpp
+// with g++ -std=c++17 -O2 -I. into searchbench, then run
+//   ./searchbench [section] [largest side]
+// Sections: workspace, bitboard, layout, all (default). The largest side (default 2048) caps
+// the map sizes, 4096 gives the full tables.
+// Every figure is the best of three runs on a map with random obstacles
+// from a fixed seed, so two builds can be compared number for number.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>    // For steady_clock
+#include <algorithm> // For min
+#include <cstdlib>   // For atoi
+#include "Pathfinding.h"
+#include "FastRandom.h"
+
+// Function to build a rows x cols map with about `percent`% blocked cells,
+// leaving a 3x3 patch open in two opposite corners
+static CityGrid makeGrid(int rows, int cols, int percent, uint64_t seed) {
+    CityGrid grid(rows, cols);
+    FastRandom random(seed);
+    long long blocked = static_cast<long long>(rows) * cols * percent / 100;
+    for (long long i = 0; i < blocked; i++) {
+        grid.setBlocked(static_cast<int>(random.nextBelow(rows)), static_cast<int>(random.nextBelow(cols)), true);
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            grid.setBlocked(i, j, false);
+            grid.setBlocked(rows - 1 - i, cols - 1 - j, false);
+        }
+    }
+    return grid;
+}
+
+// Function to time `run` three times and return the best, in seconds
+template <typename Run>
+static double bestOfThree(Run run) {
+    double best = 1e30;
+    for (int i = 0; i < 3; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// Function to time a corner-to-corner search, in milliseconds per query
+static double cornerQuery(PathfindingContext &context, PathEngine engine, const CityGrid &grid) {
+    std::vector<std::pair<int, int>> path;
+    std::pair<int, int> start = {0, 0};
+    std::pair<int, int> end = {grid.getRows() - 1, grid.getCols() - 1};
+    context.findPath(engine, grid, start, end, path); // Warm up the workspace
+    int queries = grid.getRows() <= 64 ? 1000 : 1;
+    double seconds = bestOfThree([&]() {
+        for (int i = 0; i < queries; i++) {
+            context.findPath(engine, grid, start, end, path);
+        }
+    });
+    return seconds * 1000.0 / queries;
+}
+
+// Warmed-up BFS queries
+static void benchWorkspace(int maxSide) {
+    std::cout << "BFS with a warmed-up workspace, 10% obstacles, corner to corner\n";
+    for (int side : {20, 512, 2048, 4096}) {
+        if (side > maxSide) {
+            continue;
+        }
+        CityGrid grid = makeGrid(side, side, 10, 1);
+        PathfindingContext context;
+        std::cout << "  " << std::setw(5) << side << "^2  " << std::fixed << std::setprecision(4)
+                  << cornerQuery(context, PathEngine::BFS, grid) << " ms/query\n";
+    }
+}
+
+// Scalar against bitboard BFS, across the map and over short hops
+static void benchBitboard(int maxSide) {
+    std::cout << "Scalar BFS vs bitboard BFS: corner to corner, then 1000 hops of up to 16 cells\n";
+    for (int side : {2048, 4096}) {
+        for (int percent : {0, 20, 35}) {
+            if (side > maxSide) {
+                continue;
+            }
+            CityGrid grid = makeGrid(side, side, percent, 2);
+            PathfindingContext context;
+            double scalar = cornerQuery(context, PathEngine::BFS, grid);
+            double bitboard = cornerQuery(context, PathEngine::Bitboard, grid);
+
+            FastRandom random(6);
+            std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> hops;
+            while (hops.size() < 1000) {
+                int row = static_cast<int>(random.nextBelow(side - 16));
+                int col = static_cast<int>(random.nextBelow(side - 16));
+                std::pair<int, int> a = {row, col};
+                std::pair<int, int> b = {row + static_cast<int>(random.nextBelow(16)), col + static_cast<int>(random.nextBelow(16))};
+                if (grid.isPassable(a.first, a.second) && grid.isPassable(b.first, b.second)) {
+                    hops.push_back({a, b});
+                }
+            }
+            double hopTimes[2];
+            PathEngine engines[2] = {PathEngine::BFS, PathEngine::Bitboard};
+            for (int k = 0; k < 2; k++) {
+                std::vector<std::pair<int, int>> path;
+                hopTimes[k] = bestOfThree([&]() {
+                    for (const auto &hop : hops) {
+                        context.findPath(engines[k], grid, hop.first, hop.second, path);
+                    }
+                }) * 1000.0;
+            }
+            std::cout << "  " << std::setw(5) << side << "^2 " << std::setw(2) << percent << "%  " << std::fixed
+                      << std::setprecision(1) << scalar << " ms vs " << bitboard << " ms, hops " << hopTimes[0]
+                      << " ms vs " << hopTimes[1] << " ms\n";
+        }
+    }
+}
+
+// Row-major against Z-order search arrays
+static void benchLayout(int maxSide) {
+    std::cout << "Row-major vs Z-order, 20% obstacles: BFS and distance field\n";
+    for (int side : {512, 2048, 4096}) {
+        if (side > maxSide) {
+            continue;
+        }
+        CityGrid grid = makeGrid(side, side, 20, 3);
+        double times[2][2];
+        CellOrder orders[2] = {CellOrder::RowMajor, CellOrder::ZOrder};
+        for (int k = 0; k < 2; k++) {
+            PathfindingContext context;
+            context.setCellOrder(orders[k]);
+            times[k][0] = cornerQuery(context, PathEngine::BFS, grid);
+            times[k][1] = bestOfThree([&]() { context.computeDistanceField(grid, {side / 2, side / 2}); }) * 1000.0;
+        }
+        std::cout << "  " << std::setw(5) << side << "^2  BFS " << std::fixed << std::setprecision(1) << times[0][0]
+                  << " vs " << times[1][0] << " ms, field " << times[0][1] << " vs " << times[1][1] << " ms\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string section = argc > 1 ? argv[1] : "all";
+    int maxSide = argc > 2 ? std::atoi(argv[2]) : 2048;
+    if (section == "workspace" || section == "all") benchWorkspace(maxSide);
+    if (section == "bitboard" || section == "all") benchBitboard(maxSide);
+    if (section == "layout" || section == "all") benchLayout(maxSide);
+    return 0;
+}